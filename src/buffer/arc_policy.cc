@@ -0,0 +1,122 @@
+#include "buffer/arc_policy.h"
+#include <algorithm>
+#include "buffer/buffer_manager.h"
+
+namespace buzzdb {
+
+ArcPolicy::ArcPolicy(BufferFrame* frames, size_t frame_count)
+    : frames(frames), frameCount(frame_count),
+      nodes(std::make_unique<Node[]>(frame_count)), target(0) {
+    for (size_t i = 0; i < frame_count; i++) {
+        nodes[i].frame = frames + i;
+    }
+    ghosts.reserve(frame_count);
+}
+
+ArcPolicy::Node& ArcPolicy::getNode(BufferFrame& frame) {
+    return nodes[&frame - frames];
+}
+
+size_t ArcPolicy::adaptTarget(uint64_t page_id) const {
+    auto ghost = ghosts.find(page_id);
+    if (ghost == ghosts.end()) {
+        return target;
+    }
+    if (!ghost->second.inB2) {
+        size_t delta = std::max<size_t>(1, b2.size() / b1.size());
+        return std::min(target + delta, frameCount);
+    }
+    size_t delta = std::max<size_t>(1, b1.size() / b2.size());
+    return target - std::min(delta, target);
+}
+
+void ArcPolicy::dropGhost(std::list<uint64_t>& list) {
+    ghosts.erase(list.front());
+    list.pop_front();
+}
+
+void ArcPolicy::on_admit(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    uint64_t pageId = frame.getPageId();
+    auto ghost = ghosts.find(pageId);
+    if (ghost != ghosts.end()) {
+        target = adaptTarget(pageId);
+        (ghost->second.inB2 ? b2 : b1).erase(ghost->second.position);
+        ghosts.erase(ghost);
+        t2.push_back(&node);
+        node.list = List::T2;
+    } else {
+        t1.push_back(&node);
+        node.list = List::T1;
+    }
+
+    while (t1.size() + b1.size() > frameCount && !b1.empty()) {
+        dropGhost(b1);
+    }
+    while (t1.size() + t2.size() + b1.size() + b2.size() > 2 * frameCount) {
+        dropGhost(b2.empty() ? b1 : b2);
+    }
+}
+
+void ArcPolicy::on_hit(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    if (node.list == List::T2) {
+        t2.move_to_back(&node);
+    } else {
+        t1.remove(&node);
+        t2.push_back(&node);
+        node.list = List::T2;
+    }
+}
+
+BufferFrame* ArcPolicy::pick_victim(uint64_t incoming_page_id, const VictimFilter& filter) {
+    auto ghost = ghosts.find(incoming_page_id);
+    bool inB2 = ghost != ghosts.end() && ghost->second.inB2;
+    size_t newTarget = adaptTarget(incoming_page_id);
+    bool fromT1 = !t1.empty() &&
+                  (t1.size() > newTarget || (inB2 && t1.size() == newTarget));
+
+    // Fall back to the other list when every page of the preferred one is
+    // fixed.
+    IntrusiveList<Node>* first = fromT1 ? &t1 : &t2;
+    IntrusiveList<Node>* second = fromT1 ? &t2 : &t1;
+    for (auto* list : {first, second}) {
+        for (Node* node = list->front(); node != nullptr;
+                node = IntrusiveList<Node>::next(node)) {
+            if (filter(*node->frame)) {
+                return node->frame;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ArcPolicy::on_evict(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    bool inB2 = node.list == List::T2;
+    (inB2 ? t2 : t1).remove(&node);
+    node.list = List::NONE;
+
+    std::list<uint64_t>& ghostList = inB2 ? b2 : b1;
+    ghostList.push_back(frame.getPageId());
+    ghosts[frame.getPageId()] = Ghost{inB2, std::prev(ghostList.end())};
+}
+
+std::vector<BufferFrame*> ArcPolicy::toFrames(const IntrusiveList<Node>& list) {
+    std::vector<BufferFrame*> result;
+    result.reserve(list.size());
+    for (Node* node = list.front(); node != nullptr; node = IntrusiveList<Node>::next(node)) {
+        result.push_back(node->frame);
+    }
+    return result;
+}
+
+std::vector<BufferFrame*> ArcPolicy::get_fifo_list() const {
+    return toFrames(t1);
+}
+
+std::vector<BufferFrame*> ArcPolicy::get_lru_list() const {
+    return toFrames(t2);
+}
+
+}  // namespace buzzdb
@@ -1,213 +1,907 @@
 #include "buffer/buffer_manager.h"
 #include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
 #include "storage/file.h"
 
 namespace buzzdb {
 
 // BUFFERFRAME
-BufferFrame::BufferFrame(const uint64_t page_id, const uint64_t page_size,
-                    const int64_t counter, const bool is_exclusive,
-                    const bool is_dirty) {
-    this->pageId = page_id;
-    this->pageSize = page_size;
-    this->counter = counter;
-    this->mIsExclusive = is_exclusive;
-    this->mIsDirty = is_dirty;
-    this->data.resize(page_size, 0);
+BufferFrame::BufferFrame() {
+    this->pageId = INVALID_PAGE_ID;
+    this->pageSize = 0;
+    // Free frames stay claimed until they get a page.
+    this->state.store(EVICTING, std::memory_order_relaxed);
+    this->data = nullptr;
+    this->partition = 0;
+    this->residency = Residency::FREE;
+    this->touched.store(false, std::memory_order_relaxed);
 }
 
 BufferFrame::~BufferFrame() {}
 
+void BufferFrame::reset(uint64_t page_id) {
+    this->pageId = page_id;
+    this->touched.store(false, std::memory_order_relaxed);
+    // Publishes the page id to threads that pin the frame from now on.
+    this->state.store(LOADING | 1, std::memory_order_release);
+}
+
 char* BufferFrame::get_data() {
-    return data.data();
+    return data;
 }
 
-void BufferFrame::readDisk() {
-    std::string fileName = std::to_string(BufferManager::get_segment_id(pageId));
-    std::unique_ptr<File> file = File::open_file(fileName.c_str(), File::WRITE);
+void BufferFrame::readDisk(File& file) {
     size_t offset = BufferManager::get_segment_page_id(pageId) * pageSize;
-    file->read_block(offset, pageSize, data.data());
+    file.read_block(offset, pageSize, data);
 }
 
-void BufferFrame::writeDisk() {
-    std::string fileName = std::to_string(BufferManager::get_segment_id(pageId));
-    std::unique_ptr<File> file = File::open_file(fileName.c_str(), File::WRITE);
+void BufferFrame::writeDisk(File& file) {
     size_t offset = BufferManager::get_segment_page_id(pageId) * pageSize;
-    file->write_block(data.data(), offset, pageSize);
+    file.write_block(data, offset, pageSize);
 }
 
 void BufferFrame::lockPage(const bool exclusive) {
-    exclusive == true ? pageMutex.lock() : pageMutex.lock_shared();
-    mIsExclusive = exclusive;
+    if (exclusive) {
+        latch.lock();
+    } else {
+        latch.lock_shared();
+    }
 }
 
-void BufferFrame::unlockPage(const bool is_dirty) {
-    mIsDirty = is_dirty;
-    mIsExclusive == true ? pageMutex.unlock() : pageMutex.unlock_shared();
+void BufferFrame::unlockPage() {
+    // Whoever holds the latch shared cannot see it held exclusively.
+    if (latch.is_locked_exclusively()) {
+        latch.unlock();
+    } else {
+        latch.unlock_shared();
+    }
 }
 // END BUFFERFRAME
 
+// SCANSTRATEGY
+ScanStrategy::ScanStrategy(BufferManager& buffer_manager, size_t ring_size)
+    : bufferManager(buffer_manager) {
+    size_t partitionCount = buffer_manager.partitions.size();
+    ringSize = std::max<size_t>(1, (ring_size + partitionCount - 1) / partitionCount);
+    rings.resize(partitionCount);
+}
+
+ScanStrategy::~ScanStrategy() {
+    for (size_t p = 0; p < rings.size(); p++) {
+        auto& partition = *bufferManager.partitions[p];
+        std::unique_lock managerLock(partition.managerMutex);
+        std::unique_lock queueLock(partition.queueMutex);
+        for (BufferFrame* frame : rings[p].frames) {
+            bufferManager.admitToPolicy(partition, *frame);
+        }
+    }
+}
+// END SCANSTRATEGY
+
 // BUFFERMANAGER
-BufferManager::BufferManager(size_t page_size, size_t page_count) {
-    std::unique_lock managerLock(managerMutex);
+BufferManager::BufferManager(size_t page_size, size_t page_count,
+                             const BufferManagerOptions& options)
+    : fileCache(options.max_open_files, options.file_opener ? options.file_opener :
+          [directIo = options.direct_io, syncWrites = options.sync_each_write](
+                  uint16_t segment_id) {
+              std::string fileName = std::to_string(segment_id);
+              File::OpenOptions openOptions;
+              openOptions.direct_io = directIo;
+              openOptions.sync_writes = syncWrites;
+              return File::open_file(fileName.c_str(), File::WRITE, openOptions);
+          }) {
+    if (options.partition_count == 0 || options.partition_count > page_count) {
+        throw std::invalid_argument{"partition count must be in [1, page_count]"};
+    }
+    if (options.direct_io && page_size % File::DIRECT_IO_ALIGNMENT != 0) {
+        throw std::invalid_argument{"direct I/O needs an aligned page size"};
+    }
+    if (options.replacement_policy == ReplacementPolicyType::LRU_K && options.lru_k == 0) {
+        throw std::invalid_argument{"LRU-K needs lru_k >= 1"};
+    }
+    if (options.replacement_policy == ReplacementPolicyType::SAMPLED_LRU &&
+            options.sampled_lru_sample_size == 0) {
+        throw std::invalid_argument{"sampled LRU needs a sample size >= 1"};
+    }
+    size_t smallestPartition = page_count / options.partition_count;
+    size_t probationLimit = std::max<size_t>(
+        1, options.admission_probation_ratio * smallestPartition);
+    if (options.admission_filter && probationLimit >= smallestPartition) {
+        throw std::invalid_argument{"probation ring must leave frames to the policy"};
+    }
+    size_t coolingTarget = options.cooling_ratio * smallestPartition;
+    size_t freeTarget = std::max<size_t>(1, options.free_frames_ratio * smallestPartition);
+    if (coolingTarget > 0 &&
+            (options.admission_filter || coolingTarget + freeTarget >= smallestPartition)) {
+        throw std::invalid_argument{"invalid cooling stage"};
+    }
+    size_t reservedFrames = 0;
+    for (auto& [segmentId, quota] : options.segment_quotas) {
+        if (quota.min_frames > quota.max_frames) {
+            throw std::invalid_argument{"segment quota reserves more than its cap"};
+        }
+        reservedFrames += (quota.min_frames + options.partition_count - 1) /
+            options.partition_count;
+    }
+    if (!options.segment_quotas.empty() && reservedFrames >= smallestPartition) {
+        throw std::invalid_argument{"segment quotas must leave unreserved frames"};
+    }
     pageSize = page_size;
     pageCount = page_count;
 
-    std::unique_lock queueLock(queueMutex);
-    fifoQueue.clear();
-    lruQueue.clear();
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    size_t arenaSize = page_size * page_count;
+    arenaSize = (arenaSize + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+    frameMemory = static_cast<char*>(std::aligned_alloc(FRAME_ALIGNMENT,
+                                                        std::max(arenaSize, FRAME_ALIGNMENT)));
+    if (frameMemory == nullptr) {
+        throw std::bad_alloc{};
+    }
+    frames = std::make_unique<BufferFrame[]>(page_count);
+    segmentResidency = std::make_unique<std::atomic<size_t>[]>(size_t{1} << 16);
+
+    // Hand out the frames in contiguous slices; the first partitions get one
+    // extra frame when the page count does not divide evenly.
+    size_t partitionCount = options.partition_count;
+    size_t firstFrame = 0;
+    for (size_t p = 0; p < partitionCount; p++) {
+        size_t frameCount = page_count / partitionCount + (p < page_count % partitionCount);
+        auto partition = std::make_unique<Partition>(frameCount);
+        partition->freeFrames.reserve(frameCount);
+        // Push in reverse so that frames are handed out in arena order.
+        for (size_t i = firstFrame + frameCount; i-- > firstFrame;) {
+            frames[i].data = frameMemory + i * page_size;
+            frames[i].pageSize = page_size;
+            frames[i].partition = p;
+            partition->freeFrames.push_back(&frames[i]);
+        }
+        partition->policy = ReplacementPolicy::create(options, &frames[firstFrame], frameCount);
+        if (options.admission_filter) {
+            partition->sketch = std::make_unique<FrequencySketch>(frameCount);
+            partition->probationLimit = probationLimit;
+        }
+        if (coolingTarget > 0) {
+            partition->coolingTarget = coolingTarget;
+            partition->freeTarget = freeTarget;
+        }
+        for (auto& [segmentId, quota] : options.segment_quotas) {
+            auto& state = partition->quotas[segmentId];
+            state.minFrames = (quota.min_frames + partitionCount - 1) / partitionCount;
+            state.maxFrames = std::max<size_t>(1, quota.max_frames / partitionCount);
+        }
+        partitions.push_back(std::move(partition));
+        firstFrame += frameCount;
+    }
+
+    dirtyFramesHigh = std::max<size_t>(1, options.background_writer_dirty_ratio * page_count);
+    dirtyFramesLow = dirtyFramesHigh / 2;
+    writerInterval = options.background_writer_interval;
+    flushOnDirtyRatio = options.background_writer;
+    cleanVictimWindow = options.clean_victim_window;
+    syncEachWrite = options.sync_each_write;
+    if (options.background_writer || cleanVictimWindow > 1) {
+        writerThread = std::thread([this] { runBackgroundWriter(); });
+    }
 }
 
 
 BufferManager::~BufferManager() {
-    std::unique_lock managerLock(managerMutex);
-    std::unique_lock queueLock(queueMutex);
-    for (auto entry : bufferMapping) {
-        BufferFrame* page = entry.second;
-        if (page->isDirty()) {
-            page->writeDisk();
+    if (writerThread.joinable()) {
+        {
+            std::unique_lock writerLock(writerMutex);
+            writerStop = true;
         }
-        delete entry.second;
+        writerCondition.notify_one();
+        writerThread.join();
     }
+    flush_all();
+    partitions.clear();
+    frames.reset();
+    std::free(frameMemory);
+}
+
+void BufferManager::readPage(BufferFrame& frame) {
+    frame.readDisk(*fileCache.get(get_segment_id(frame.pageId)));
 }
 
-int BufferManager::getPageIndexToRemove(bool isFifo) {
-    if (isFifo) {
-        for (int i = 0; i < static_cast<int>(fifoQueue.size()); i++) {
-            BufferFrame *tempPage = bufferMapping.at(fifoQueue[i]);
-            if (tempPage->getCounter() != 0) { continue; }
-            tempPage->writeDisk();
-            return i;
+void BufferManager::loadPage(BufferFrame& frame, bool exclusive) {
+    try {
+        readPage(frame);
+    } catch (...) {
+        frame.unlockPage();
+        frame.decCounter();
+        throw;
+    }
+    frame.finishLoading();
+    if (!exclusive) {
+        frame.unlockPage();
+        frame.lockPage(false);
+    }
+}
+
+BufferFrame& BufferManager::latchResidentPage(BufferFrame& frame, bool exclusive) {
+    if (frame.isLoading()) {
+        coalescedMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+    frame.lockPage(exclusive);
+    if (frame.isLoading()) {
+        // The read that was to load the page failed. Reading it needs the
+        // exclusive latch, and someone else may get to it first.
+        if (!exclusive) {
+            frame.unlockPage();
+            frame.lockPage(true);
         }
-    } else {
-        for (int i = 0; i < static_cast<int>(lruQueue.size()); i++) {
-            BufferFrame *tempPage = bufferMapping.at(lruQueue[i]);
-            if (tempPage->getCounter() != 0) { continue; }
-            tempPage->writeDisk();
-            return i;
+        if (frame.isLoading()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            loadPage(frame, exclusive);
+        } else if (!exclusive) {
+            frame.unlockPage();
+            frame.lockPage(false);
         }
     }
-    return -1;
+    return frame;
 }
 
-BufferFrame& BufferManager::removePage(uint64_t page_id, int indexToRemove, bool exclusive, bool isFifo) {
-    BufferFrame * pFrame = nullptr;
-    pFrame = new BufferFrame(page_id, pageSize);
-    pFrame->incCounter();
-    if (isFifo) {
-        bufferMapping.erase(fifoQueue[indexToRemove]);
-        bufferMapping.insert(std::pair<uint64_t, BufferFrame*>(page_id, pFrame));
+void BufferManager::writePage(BufferFrame& frame) {
+    uint16_t segmentId = get_segment_id(frame.pageId);
+    frame.writeDisk(*fileCache.get(segmentId));
+    writebacks.fetch_add(1, std::memory_order_relaxed);
+    if (!syncEachWrite) {
+        std::unique_lock unsyncedLock(unsyncedMutex);
+        if (unsyncedSegments.size() <= segmentId) {
+            unsyncedSegments.resize(segmentId + 1);
+        }
+        unsyncedSegments[segmentId] = true;
+    }
+}
+
+void BufferManager::writeFixedPage(BufferFrame& frame) {
+    frame.latch.lock_shared();
+    try {
+        writePage(frame);
+    } catch (...) {
+        frame.latch.unlock_shared();
+        frame.decCounter();
+        throw;
+    }
+    markClean(frame);
+    frame.latch.unlock_shared();
+    frame.decCounter();
+}
+
+void BufferManager::markClean(BufferFrame& frame) {
+    if (frame.markClean()) {
+        dirtyFrames.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void BufferManager::runBackgroundWriter() {
+    std::unique_lock writerLock(writerMutex);
+    auto dirtyRatioReached = [this] {
+        return flushOnDirtyRatio &&
+            dirtyFrames.load(std::memory_order_relaxed) >= dirtyFramesHigh;
+    };
+    // Each round starts at the partition after the one it started at last,
+    // so that the first partitions do not take all of the writes.
+    size_t firstPartition = 0;
+    while (!writerStop) {
+        writerCondition.wait_for(writerLock, writerInterval, [&] {
+            return writerStop || !writeRequests.empty() || dirtyRatioReached();
+        });
+        if (writerStop) {
+            continue;
+        }
+        std::vector<uint64_t> requests;
+        requests.swap(writeRequests);
+        writerLock.unlock();
+        writeRequestedPages(requests);
+        if (dirtyRatioReached()) {
+            // Once started, write until the low mark is reached.
+            for (size_t i = 0; i < partitions.size(); i++) {
+                if (dirtyFrames.load(std::memory_order_relaxed) <= dirtyFramesLow) {
+                    break;
+                }
+                flushPartition(*partitions[(firstPartition + i) % partitions.size()]);
+            }
+            firstPartition = (firstPartition + 1) % partitions.size();
+        }
+        writerLock.lock();
+    }
+}
+
+size_t BufferManager::flushPartition(Partition& partition) {
+    // Collect a batch of candidates in eviction order, then fix and write
+    // them one at a time, so the writer never holds more than one frame that
+    // a miss could otherwise evict.
+    constexpr size_t batchSize = 32;
+    size_t written = 0;
+    while (true) {
+        size_t dirty = dirtyFrames.load(std::memory_order_relaxed);
+        if (dirty <= dirtyFramesLow) {
+            break;
+        }
+        size_t limit = std::min(batchSize, dirty - dirtyFramesLow);
+        std::vector<uint64_t> batch;
+        {
+            std::shared_lock managerLock(partition.managerMutex);
+            std::unique_lock queueLock(partition.queueMutex);
+            std::vector<BufferFrame*> outsidePolicy(partition.cooling.begin(),
+                                                    partition.cooling.end());
+            outsidePolicy.insert(outsidePolicy.end(), partition.probation.begin(),
+                                 partition.probation.end());
+            for (auto queue : {std::move(outsidePolicy), partition.policy->get_fifo_list(),
+                               partition.policy->get_lru_list()}) {
+                for (BufferFrame* frame : queue) {
+                    if (batch.size() == limit) {
+                        break;
+                    }
+                    if (frame->getCounter() == 0 && frame->isDirty()) {
+                        batch.push_back(frame->pageId);
+                    }
+                }
+            }
+        }
+        if (batch.empty()) {
+            break;
+        }
+        size_t batchWritten = writeRequestedPages(batch);
+        if (batchWritten == 0) {
+            break;
+        }
+        written += batchWritten;
+    }
+    return written;
+}
+
+size_t BufferManager::writeRequestedPages(const std::vector<uint64_t>& page_ids) {
+    size_t written = 0;
+    for (uint64_t page_id : page_ids) {
+        Partition& partition = getPartition(page_id);
+        BufferFrame* frame;
+        {
+            std::shared_lock managerLock(partition.managerMutex);
+            std::unique_lock queueLock(partition.queueMutex);
+            frame = partition.pageTable.find(page_id);
+            if (frame == nullptr || frame->getCounter() != 0 || !frame->isDirty()) {
+                continue;
+            }
+            frame->incCounter();
+        }
+        try {
+            writeFixedPage(*frame);
+        } catch (...) {
+            // Leave the page dirty; eviction will retry the write.
+            continue;
+        }
+        backgroundWritebacks.fetch_add(1, std::memory_order_relaxed);
+        written++;
+    }
+    return written;
+}
 
-        fifoQueue.erase(fifoQueue.begin() + indexToRemove);
-        fifoQueue.push_back(page_id);
+bool BufferManager::segmentAtCap(const Partition& partition, uint64_t page_id) const {
+    auto quota = partition.quotas.find(get_segment_id(page_id));
+    return quota != partition.quotas.end() && quota->second.resident >= quota->second.maxFrames;
+}
+
+void BufferManager::countResident(Partition& partition, uint64_t page_id, int delta) {
+    uint16_t segmentId = get_segment_id(page_id);
+    segmentResidency[segmentId].fetch_add(delta, std::memory_order_relaxed);
+    auto quota = partition.quotas.find(segmentId);
+    if (quota != partition.quotas.end()) {
+        quota->second.resident += delta;
+    }
+}
+
+BufferFrame* BufferManager::getPageToRemove(Partition& partition, uint64_t page_id) {
+    ReplacementPolicy::VictimFilter evictable = [](BufferFrame& frame) {
+        return frame.getCounter() == 0;
+    };
+    if (!partition.quotas.empty()) {
+        uint16_t segmentId = get_segment_id(page_id);
+        bool atCap = segmentAtCap(partition, page_id);
+        evictable = [&partition, segmentId, atCap](BufferFrame& frame) {
+            if (frame.getCounter() != 0) {
+                return false;
+            }
+            // A segment at its cap replaces its own pages. Other segments
+            // leave pages of segments that are down to their reservation.
+            uint16_t victimSegment = get_segment_id(frame.pageId);
+            if (atCap || victimSegment == segmentId) {
+                return victimSegment == segmentId;
+            }
+            auto quota = partition.quotas.find(victimSegment);
+            return quota == partition.quotas.end() ||
+                quota->second.resident > quota->second.minFrames;
+        };
+    }
+    // Hits pin frames without the partition latch, so a victim may get
+    // pinned before it is claimed. The policy then picks again.
+    if (cleanVictimWindow <= 1) {
+        while (true) {
+            BufferFrame* victim = partition.policy->pick_victim(page_id, evictable);
+            if (victim == nullptr || victim->tryClaim()) {
+                return victim;
+            }
+        }
+    }
+
+    // Policies may offer a frame more than once, as CLOCK does on its second
+    // revolution. A dirty frame that comes around again is taken, since no
+    // clean frame was found in between.
+    std::vector<uint64_t> skipped;
+    BufferFrame* victim;
+    do {
+        skipped.clear();
+        size_t candidates = 0;
+        victim = partition.policy->pick_victim(page_id, [&](BufferFrame& frame) {
+            if (!evictable(frame)) {
+                return false;
+            }
+            if (!frame.isDirty() ||
+                std::find(skipped.begin(), skipped.end(), frame.pageId) != skipped.end() ||
+                ++candidates == cleanVictimWindow) {
+                return true;
+            }
+            skipped.push_back(frame.pageId);
+            return false;
+        });
+    } while (victim != nullptr && !victim->tryClaim());
+    if (victim != nullptr) {
+        // The victim is written on eviction if it was skipped before.
+        skipped.erase(std::remove(skipped.begin(), skipped.end(), victim->pageId),
+                      skipped.end());
+    }
+    if (!skipped.empty()) {
+        dirtyVictimsSkipped.fetch_add(skipped.size(), std::memory_order_relaxed);
+        {
+            std::unique_lock writerLock(writerMutex);
+            // Drop requests when the writer falls behind; the pages are
+            // written on eviction then.
+            if (writeRequests.size() < pageCount) {
+                writeRequests.insert(writeRequests.end(), skipped.begin(), skipped.end());
+            }
+        }
+        writerCondition.notify_one();
+    }
+    return victim;
+}
+
+void BufferManager::evictPage(Partition& partition, BufferFrame& victim) {
+    if (victim.isDirty()) {
+        try {
+            writePage(victim);
+        } catch (...) {
+            victim.releaseClaim();
+            throw;
+        }
+        markClean(victim);
+        foregroundWritebacks.fetch_add(1, std::memory_order_relaxed);
     } else {
-        bufferMapping.erase(lruQueue[indexToRemove]);
-        bufferMapping.insert(std::pair<uint64_t, BufferFrame*>(page_id, pFrame));
+        writebacksAvoided.fetch_add(1, std::memory_order_relaxed);
+    }
+    partition.pageTable.erase(victim.pageId);
+    countResident(partition, victim.pageId, -1);
+    if (victim.residency == BufferFrame::Residency::POLICY) {
+        partition.policy->on_evict(victim);
+    } else if (victim.residency == BufferFrame::Residency::PROBATION) {
+        auto& probation = partition.probation;
+        probation.erase(std::find(probation.begin(), probation.end(), &victim));
+    } else if (victim.residency == BufferFrame::Residency::COOLING) {
+        auto& cooling = partition.cooling;
+        cooling.erase(std::find(cooling.begin(), cooling.end(), &victim));
+    }
+    victim.residency = BufferFrame::Residency::FREE;
+}
 
-        lruQueue.erase(lruQueue.begin() + indexToRemove);
-        fifoQueue.push_back(page_id);
+void BufferManager::refillFreeFrames(Partition& partition, uint64_t page_id) {
+    auto& cooling = partition.cooling;
+    auto topUpCooling = [&] {
+        while (cooling.size() < partition.coolingTarget) {
+            BufferFrame* victim = getPageToRemove(partition, page_id);
+            if (victim == nullptr) {
+                break;
+            }
+            partition.policy->on_evict(*victim);
+            victim->residency = BufferFrame::Residency::COOLING;
+            victim->touched.store(false, std::memory_order_relaxed);
+            cooling.push_back(victim);
+            victim->releaseClaim();
+        }
+    };
+
+    while (partition.freeFrames.size() < partition.freeTarget) {
+        if (cooling.empty()) {
+            topUpCooling();
+            if (cooling.empty()) {
+                break;
+            }
+        }
+        BufferFrame* frame = cooling.front();
+        if (frame->touched.load(std::memory_order_relaxed) || !frame->tryClaim()) {
+            // Used again while cooling, so the page is still hot.
+            cooling.pop_front();
+            frame->residency = BufferFrame::Residency::POLICY;
+            partition.policy->on_admit(*frame);
+            coolingRescues.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        evictPage(partition, *frame);
+        partition.freeFrames.push_back(frame);
     }
-    queueMutex.unlock();
-    managerMutex.unlock();
-    pFrame->lockPage(exclusive);
-    pFrame->readDisk();
-    return *pFrame;
+    topUpCooling();
 }
 
-BufferFrame& BufferManager::updateExistingPage(uint64_t page_id, bool exclusive) {
-    auto entry = bufferMapping.find(page_id);
-    BufferFrame* pFrame = entry->second;
-    pFrame->incCounter();
-    auto lruPage = std::find(std::begin(lruQueue), std::end(lruQueue), page_id);
-    auto fifoPage = std::find(std::begin(fifoQueue), std::end(fifoQueue), page_id);
-    if (lruPage != std::end(lruQueue)) {
-        lruQueue.erase(lruPage);
-    }  else {
-        fifoQueue.erase(fifoPage);
+BufferFrame* BufferManager::takeFrame(Partition& partition, uint64_t page_id) {
+    if (partition.freeFrames.empty() && partition.coolingTarget > 0) {
+        refillFreeFrames(partition, page_id);
     }
-    lruQueue.push_back(page_id);
+    if (!partition.freeFrames.empty()) {
+        BufferFrame* frame = partition.freeFrames.back();
+        partition.freeFrames.pop_back();
+        return frame;
+    }
+    BufferFrame* victim = getPageToRemove(partition, page_id);
+    if (victim == nullptr) {
+        // Every page the policy tracks is fixed, but a cooling page may not be.
+        for (BufferFrame* frame : partition.cooling) {
+            if (frame->tryClaim()) {
+                victim = frame;
+                break;
+            }
+        }
+    }
+    if (victim == nullptr) {
+        throw buffer_full_error{};
+    }
+    evictPage(partition, *victim);
+    return victim;
+}
 
-    queueMutex.unlock();
-    managerMutex.unlock();
-    pFrame->lockPage(exclusive);
+void BufferManager::admitToPolicy(Partition& partition, BufferFrame& frame) {
+    if (frame.residency == BufferFrame::Residency::RING) {
+        frame.residency = BufferFrame::Residency::POLICY;
+        partition.policy->on_admit(frame);
+    }
+}
 
-    return *pFrame;
+BufferFrame* BufferManager::addRingPage(Partition& partition, uint64_t page_id,
+                                        ScanStrategy& strategy) {
+    auto& ring = strategy.rings[getPartitionIndex(page_id)];
+    if (ring.frames.size() < strategy.ringSize) {
+        BufferFrame* frame = takeFrame(partition, page_id);
+        ring.frames.push_back(frame);
+        return addNewPage(partition, page_id, *frame, BufferFrame::Residency::RING);
+    }
+
+    size_t slot = ring.next;
+    ring.next = (ring.next + 1) % ring.frames.size();
+    BufferFrame* frame = ring.frames[slot];
+    if (!frame->touched.load(std::memory_order_relaxed) && frame->tryClaim()) {
+        evictPage(partition, *frame);
+    } else {
+        // Somebody else uses the page, so keep it in the pool.
+        admitToPolicy(partition, *frame);
+        frame = takeFrame(partition, page_id);
+        ring.frames[slot] = frame;
+    }
+    return addNewPage(partition, page_id, *frame, BufferFrame::Residency::RING);
 }
 
-BufferFrame& BufferManager::addNewPage(uint64_t page_id, bool exclusive) {
-    BufferFrame *pFrame = new BufferFrame(page_id, pageSize);
-    pFrame->incCounter();
+BufferFrame* BufferManager::replacePage(Partition& partition, uint64_t page_id) {
+    BufferFrame* victim = getPageToRemove(partition, page_id);
+    FrequencySketch* sketch = partition.sketch.get();
+    if (sketch == nullptr ||
+            (victim != nullptr && sketch->estimate(page_id) > sketch->estimate(victim->pageId))) {
+        if (victim == nullptr) {
+            throw buffer_full_error{};
+        }
+        evictPage(partition, *victim);
+        return addNewPage(partition, page_id, *victim);
+    }
 
-    bufferMapping.insert(std::pair<uint64_t, BufferFrame*>(page_id, pFrame));
-    fifoQueue.push_back(page_id);
+    // The newcomer is not more popular than the victim and goes on probation.
+    // Until the ring is full it takes the victim's frame.
+    auto& probation = partition.probation;
+    BufferFrame* candidate = nullptr;
+    if (probation.size() == partition.probationLimit || victim == nullptr) {
+        for (BufferFrame* frame : probation) {
+            if (frame->tryClaim()) {
+                candidate = frame;
+                break;
+            }
+        }
+    }
+    if (candidate == nullptr) {
+        if (victim == nullptr) {
+            throw buffer_full_error{};
+        }
+        evictPage(partition, *victim);
+        if (probation.size() == partition.probationLimit) {
+            // Every page on probation is fixed, so admit the newcomer.
+            return addNewPage(partition, page_id, *victim);
+        }
+    } else if (victim != nullptr &&
+            sketch->estimate(candidate->pageId) > sketch->estimate(victim->pageId)) {
+        // The oldest page on probation has proven itself since it arrived and
+        // takes the victim's place in the policy.
+        try {
+            evictPage(partition, *victim);
+        } catch (...) {
+            candidate->releaseClaim();
+            throw;
+        }
+        candidate->releaseClaim();
+        probation.erase(std::find(probation.begin(), probation.end(), candidate));
+        candidate->residency = BufferFrame::Residency::POLICY;
+        partition.policy->on_admit(*candidate);
+    } else {
+        if (victim != nullptr) {
+            victim->releaseClaim();
+        }
+        evictPage(partition, *candidate);
+        victim = candidate;
+    }
+    admissionsRejected.fetch_add(1, std::memory_order_relaxed);
+    return addNewPage(partition, page_id, *victim, BufferFrame::Residency::PROBATION);
+}
 
-    queueMutex.unlock();
-    managerMutex.unlock();
-    pFrame->lockPage(exclusive);
+void BufferManager::updateExistingPage(Partition& partition, BufferFrame& frame,
+                                       ScanStrategy* strategy) {
+    if (partition.sketch != nullptr) {
+        partition.sketch->increment(frame.pageId);
+    }
+    if (frame.residency == BufferFrame::Residency::POLICY) {
+        partition.policy->on_hit(frame);
+    } else if ((frame.residency == BufferFrame::Residency::RING && strategy == nullptr) ||
+            frame.residency == BufferFrame::Residency::COOLING) {
+        frame.touched.store(true, std::memory_order_relaxed);
+    }
+}
 
-    pFrame->readDisk();
-    return *pFrame;
+BufferFrame* BufferManager::addNewPage(Partition& partition, uint64_t page_id,
+                                       BufferFrame& frame, BufferFrame::Residency residency) {
+    BufferFrame *pFrame = &frame;
+    // Latch the frame before it can be fixed again, so that hits wait until
+    // the page has been read. Nobody else holds the latch of a frame that
+    // was free or claimed.
+    pFrame->latch.lock();
+    pFrame->reset(page_id);
+    pFrame->residency = residency;
+
+    partition.pageTable.insert(page_id, pFrame);
+    countResident(partition, page_id, 1);
+    if (residency == BufferFrame::Residency::POLICY) {
+        partition.policy->on_admit(*pFrame);
+    } else if (residency == BufferFrame::Residency::PROBATION) {
+        partition.probation.push_back(pFrame);
+    }
+    return pFrame;
 }
 
 
 BufferFrame& BufferManager::fix_page(uint64_t page_id, bool exclusive) {
-    managerMutex.lock();
-    queueMutex.lock();
+    return fixPage(page_id, exclusive, nullptr);
+}
+
+
+BufferFrame& BufferManager::fix_page(uint64_t page_id, bool exclusive,
+                                     ScanStrategy& strategy) {
+    return fixPage(page_id, exclusive, &strategy);
+}
 
-    bool bufferContainsPage = bufferMapping.find(page_id) != bufferMapping.end();
-    if (bufferContainsPage) {
-        return updateExistingPage(page_id, exclusive);
-    }
 
-    bool bufferIsFull = bufferMapping.size() == pageCount;
-    if (!bufferIsFull) {
-        return addNewPage(page_id, exclusive);
+BufferFrame& BufferManager::fixPage(uint64_t page_id, bool exclusive, ScanStrategy* strategy) {
+    Partition& partition = getPartition(page_id);
+    {
+        // Hits pin the frame without the manager latch and serialize on the
+        // queue latch alone, or not at all when the policy does not need it.
+        // The lookup may race with a miss that gives the frame another page,
+        // so the page id is checked once the pin keeps the frame in place.
+        BufferFrame* pFrame = partition.pageTable.find(page_id);
+        if (pFrame != nullptr && pFrame->tryPin()) {
+            if (pFrame->pageId == page_id) {
+                if (partition.policy->is_access_latch_free()) {
+                    updateExistingPage(partition, *pFrame, strategy);
+                } else {
+                    std::unique_lock queueLock(partition.queueMutex);
+                    updateExistingPage(partition, *pFrame, strategy);
+                }
+                return latchResidentPage(*pFrame, exclusive);
+            }
+            pFrame->decCounter();
+        }
     }
 
-    int fifoToRemove = getPageIndexToRemove(true);
-    if (fifoToRemove != -1) {
-        return removePage(page_id, fifoToRemove, exclusive, true);
+    std::unique_lock managerLock(partition.managerMutex);
+    std::unique_lock queueLock(partition.queueMutex);
+
+    // Another thread may have loaded the page while no latch was held.
+    BufferFrame* pFrame = partition.pageTable.find(page_id);
+    if (pFrame != nullptr) {
+        // Nothing is claimed while the manager latch is held exclusively.
+        pFrame->incCounter();
+        updateExistingPage(partition, *pFrame, strategy);
+        queueLock.unlock();
+        managerLock.unlock();
+        return latchResidentPage(*pFrame, exclusive);
     }
 
-    int lruToRemove = getPageIndexToRemove(false);
-    if (lruToRemove != -1) {
-        return removePage(page_id, lruToRemove, exclusive, false);
+    if (partition.sketch != nullptr && strategy == nullptr) {
+        partition.sketch->increment(page_id);
+    }
+    bool bufferIsFull = partition.freeFrames.empty();
+    if (strategy != nullptr) {
+        pFrame = addRingPage(partition, page_id, *strategy);
+    } else if (segmentAtCap(partition, page_id)) {
+        // Free frames are off limits too; the segment replaces its own page.
+        BufferFrame* victim = getPageToRemove(partition, page_id);
+        for (auto* queue : {&partition.cooling, &partition.probation}) {
+            for (auto it = queue->begin(); victim == nullptr && it != queue->end(); ++it) {
+                if (get_segment_id((*it)->pageId) == get_segment_id(page_id) &&
+                        (*it)->tryClaim()) {
+                    victim = *it;
+                }
+            }
+        }
+        if (victim == nullptr) {
+            throw buffer_full_error{};
+        }
+        evictPage(partition, *victim);
+        pFrame = addNewPage(partition, page_id, *victim);
+    } else if (!bufferIsFull) {
+        pFrame = addNewPage(partition, page_id, *partition.freeFrames.back());
+        partition.freeFrames.pop_back();
+    } else if (partition.coolingTarget > 0) {
+        pFrame = addNewPage(partition, page_id, *takeFrame(partition, page_id));
+    } else {
+        pFrame = replacePage(partition, page_id);
     }
 
-    queueMutex.unlock();
-    managerMutex.unlock();
+    misses.fetch_add(1, std::memory_order_relaxed);
 
-    throw buffer_full_error{};
+    // addNewPage() latched the frame exclusively, so hits and optimistic
+    // readers wait until the page has been read.
+    queueLock.unlock();
+    managerLock.unlock();
+    loadPage(*pFrame, exclusive);
+    return *pFrame;
 }
 
 
 void BufferManager::unfix_page(BufferFrame& page, bool is_dirty) {
-    std::unique_lock managerLock(managerMutex);
-    std::unique_lock queueLock(queueMutex);
+    Partition& partition = *partitions[page.partition];
+    page.unlockPage();
+    // The frame cannot be evicted before the pin is dropped, so the policy
+    // hook runs first.
+    if (partition.policy->is_access_latch_free()) {
+        partition.policy->on_unfix(page);
+    } else {
+        std::unique_lock queueLock(partition.queueMutex);
+        partition.policy->on_unfix(page);
+    }
+    // Only a successful write-back makes the page clean again.
+    bool becameDirty = page.unpin(is_dirty);
+    if (becameDirty &&
+            dirtyFrames.fetch_add(1, std::memory_order_relaxed) + 1 == dirtyFramesHigh &&
+            writerThread.joinable()) {
+        writerCondition.notify_one();
+    }
+}
+
+
+bool BufferManager::try_upgrade_page(BufferFrame& page) {
+    return page.latch.try_upgrade();
+}
+
+
+bool BufferManager::upgrade_page(BufferFrame& page) {
+    return page.latch.upgrade();
+}
+
+
+void BufferManager::downgrade_page(BufferFrame& page) {
+    page.latch.downgrade();
+}
 
-    page.decCounter();
-    page.unlockPage(is_dirty);
-    auto lruPage = std::find(std::begin(lruQueue), std::end(lruQueue), page.pageId);
 
-    if (lruPage == std::end(lruQueue)) {
+void BufferManager::flush_all() {
+    for (auto& partition : partitions) {
+        std::vector<uint64_t> dirty;
+        {
+            std::shared_lock managerLock(partition->managerMutex);
+            std::unique_lock queueLock(partition->queueMutex);
+            partition->pageTable.for_each([&dirty](uint64_t page_id, BufferFrame* frame) {
+                if (frame->isDirty()) {
+                    dirty.push_back(page_id);
+                }
+            });
+        }
+        // Fix one page at a time, so that misses can still evict the others
+        // while this waits for a page latch.
+        for (uint64_t page_id : dirty) {
+            BufferFrame* frame;
+            {
+                std::shared_lock managerLock(partition->managerMutex);
+                std::unique_lock queueLock(partition->queueMutex);
+                frame = partition->pageTable.find(page_id);
+                if (frame == nullptr || !frame->isDirty()) {
+                    continue;
+                }
+                frame->incCounter();
+            }
+            writeFixedPage(*frame);
+        }
+    }
+
+    if (syncEachWrite) {
         return;
     }
+    std::vector<bool> segments;
+    {
+        std::unique_lock unsyncedLock(unsyncedMutex);
+        segments.swap(unsyncedSegments);
+    }
+    for (size_t segmentId = 0; segmentId < segments.size(); segmentId++) {
+        if (!segments[segmentId]) {
+            continue;
+        }
+        try {
+            fileCache.get(segmentId)->sync();
+        } catch (...) {
+            // Keep the remaining segments for the next attempt.
+            std::unique_lock unsyncedLock(unsyncedMutex);
+            unsyncedSegments.resize(std::max(unsyncedSegments.size(), segments.size()));
+            for (size_t j = segmentId; j < segments.size(); j++) {
+                if (segments[j]) {
+                    unsyncedSegments[j] = true;
+                }
+            }
+            throw;
+        }
+    }
+}
+
 
-    lruQueue.erase(lruPage);
-    lruQueue.push_back(page.pageId);
-    return;
+BufferManagerStats BufferManager::get_stats() const {
+    BufferManagerStats stats;
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.writebacks = writebacks.load(std::memory_order_relaxed);
+    stats.writebacks_avoided = writebacksAvoided.load(std::memory_order_relaxed);
+    stats.admissions_rejected = admissionsRejected.load(std::memory_order_relaxed);
+    stats.cooling_rescues = coolingRescues.load(std::memory_order_relaxed);
+    stats.background_writebacks = backgroundWritebacks.load(std::memory_order_relaxed);
+    stats.foreground_writebacks = foregroundWritebacks.load(std::memory_order_relaxed);
+    stats.dirty_victims_skipped = dirtyVictimsSkipped.load(std::memory_order_relaxed);
+    stats.coalesced_misses = coalescedMisses.load(std::memory_order_relaxed);
+    return stats;
 }
 
 
 std::vector<uint64_t> BufferManager::get_fifo_list() const {
-    std::unique_lock queueLock(queueMutex);
-    return fifoQueue;
+    std::vector<uint64_t> pageIds;
+    for (auto& partition : partitions) {
+        std::unique_lock queueLock(partition->queueMutex);
+        for (BufferFrame* page : partition->policy->get_fifo_list()) {
+            pageIds.push_back(page->pageId);
+        }
+    }
+    return pageIds;
 }
 
 
 std::vector<uint64_t> BufferManager::get_lru_list() const {
-    std::unique_lock queueLock(queueMutex);
-    return lruQueue;
+    std::vector<uint64_t> pageIds;
+    for (auto& partition : partitions) {
+        std::unique_lock queueLock(partition->queueMutex);
+        for (BufferFrame* page : partition->policy->get_lru_list()) {
+            pageIds.push_back(page->pageId);
+        }
+    }
+    return pageIds;
 }
 
 }  // namespace buzzdb
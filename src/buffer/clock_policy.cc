@@ -0,0 +1,68 @@
+#include "buffer/clock_policy.h"
+#include "buffer/buffer_manager.h"
+
+namespace buzzdb {
+
+ClockPolicy::ClockPolicy(BufferFrame* frames, size_t frame_count)
+    : frames(frames), frameCount(frame_count),
+      referenced(std::make_unique<std::atomic<bool>[]>(frame_count)),
+      resident(frame_count, false), hand(0) {
+    for (size_t i = 0; i < frame_count; i++) {
+        referenced[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+void ClockPolicy::on_admit(BufferFrame& frame) {
+    // The fix that loads the page does not count as a reference, so a page
+    // needs a second access before it survives a sweep.
+    size_t index = &frame - frames;
+    resident[index] = true;
+    referenced[index].store(false, std::memory_order_relaxed);
+}
+
+void ClockPolicy::on_hit(BufferFrame& frame) {
+    // Check first so that hot pages do not keep dirtying the cache line.
+    std::atomic<bool>& bit = referenced[&frame - frames];
+    if (!bit.load(std::memory_order_relaxed)) {
+        bit.store(true, std::memory_order_relaxed);
+    }
+}
+
+BufferFrame* ClockPolicy::pick_victim(uint64_t, const VictimFilter& filter) {
+    // The first revolution clears every set bit. Hits set bits without the
+    // queue latch, so concurrent hits may set them again behind the hand;
+    // the third revolution therefore ignores the bits and only fails when
+    // the filter rejects all frames.
+    for (size_t step = 0; step < 3 * frameCount; step++) {
+        size_t index = hand;
+        hand = (hand + 1 == frameCount) ? 0 : hand + 1;
+        if (!resident[index]) {
+            continue;
+        }
+        if (step < 2 * frameCount && referenced[index].load(std::memory_order_relaxed)) {
+            referenced[index].store(false, std::memory_order_relaxed);
+            continue;
+        }
+        if (filter(frames[index])) {
+            return &frames[index];
+        }
+    }
+    return nullptr;
+}
+
+void ClockPolicy::on_evict(BufferFrame& frame) {
+    resident[&frame - frames] = false;
+}
+
+std::vector<BufferFrame*> ClockPolicy::get_fifo_list() const {
+    std::vector<BufferFrame*> result;
+    for (size_t step = 0; step < frameCount; step++) {
+        size_t index = (hand + step) % frameCount;
+        if (resident[index]) {
+            result.push_back(&frames[index]);
+        }
+    }
+    return result;
+}
+
+}  // namespace buzzdb
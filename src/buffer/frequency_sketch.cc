@@ -0,0 +1,71 @@
+#include "buffer/frequency_sketch.h"
+#include <algorithm>
+#include "buffer/page_table.h"
+
+namespace buzzdb {
+
+FrequencySketch::FrequencySketch(size_t expected_entries) {
+    size_t width = 64;
+    while (width < expected_entries) {
+        width *= 2;
+    }
+    mask = width - 1;
+    wordCount = DEPTH * width / 16;
+    words = std::make_unique<std::atomic<uint64_t>[]>(wordCount);
+    for (size_t i = 0; i < wordCount; i++) {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+    sampleSize = 10 * std::max<size_t>(expected_entries, 1);
+    additions.store(0, std::memory_order_relaxed);
+}
+
+size_t FrequencySketch::counterIndex(uint64_t hash, size_t row) const {
+    // Double hashing: the rows probe with independent-enough strides.
+    uint64_t h1 = hash;
+    uint64_t h2 = (hash >> 32) | 1;
+    return row * (mask + 1) + ((h1 + row * h2) & mask);
+}
+
+void FrequencySketch::increment(uint64_t page_id) {
+    uint64_t hash = PageTable::hash(page_id);
+    bool added = false;
+    for (size_t row = 0; row < DEPTH; row++) {
+        size_t index = counterIndex(hash, row);
+        std::atomic<uint64_t>& word = words[index / 16];
+        size_t shift = (index % 16) * 4;
+        uint64_t value = word.load(std::memory_order_relaxed);
+        while (((value >> shift) & MAX_COUNT) != MAX_COUNT) {
+            if (word.compare_exchange_weak(value, value + (uint64_t{1} << shift),
+                                           std::memory_order_relaxed)) {
+                added = true;
+                break;
+            }
+        }
+    }
+    if (added && additions.fetch_add(1, std::memory_order_relaxed) + 1 == sampleSize) {
+        halve();
+    }
+}
+
+uint32_t FrequencySketch::estimate(uint64_t page_id) const {
+    uint64_t hash = PageTable::hash(page_id);
+    uint64_t result = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; row++) {
+        size_t index = counterIndex(hash, row);
+        uint64_t value = words[index / 16].load(std::memory_order_relaxed);
+        result = std::min(result, (value >> ((index % 16) * 4)) & MAX_COUNT);
+    }
+    return result;
+}
+
+void FrequencySketch::halve() {
+    for (size_t i = 0; i < wordCount; i++) {
+        uint64_t value = words[i].load(std::memory_order_relaxed);
+        while (!words[i].compare_exchange_weak(value, (value >> 1) & 0x7777777777777777ull,
+                                               std::memory_order_relaxed)) {
+        }
+    }
+    additions.fetch_sub(sampleSize / 2, std::memory_order_relaxed);
+}
+
+}  // namespace buzzdb
@@ -0,0 +1,183 @@
+#include "buffer/lru_k_policy.h"
+#include <algorithm>
+#include <stdexcept>
+#include "buffer/buffer_manager.h"
+
+namespace buzzdb {
+
+LruKPolicy::LruKPolicy(BufferFrame* frames, size_t frame_count, size_t k,
+                       uint64_t correlated_period)
+    : frames(frames), k(k), correlatedPeriod(correlated_period), clock(0),
+      history(frame_count * k, 0), lastAccess(frame_count, 0),
+      heapPosition(frame_count, NOT_IN_HEAP), retainedPageIds(frame_count, INVALID_PAGE_ID),
+      retainedHistory(frame_count * k, 0), nextRetained(0) {
+    if (k == 0) {
+        throw std::invalid_argument{"LRU-K needs k >= 1"};
+    }
+    heap.reserve(frame_count);
+    retained.reserve(frame_count);
+}
+
+void LruKPolicy::place(size_t position, uint32_t frame) {
+    heap[position] = frame;
+    heapPosition[frame] = position;
+}
+
+void LruKPolicy::siftUp(size_t position) {
+    uint32_t frame = heap[position];
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+        if (!less(frame, heap[parent])) {
+            break;
+        }
+        place(position, heap[parent]);
+        position = parent;
+    }
+    place(position, frame);
+}
+
+void LruKPolicy::siftDown(size_t position) {
+    uint32_t frame = heap[position];
+    while (true) {
+        size_t child = 2 * position + 1;
+        if (child >= heap.size()) {
+            break;
+        }
+        if (child + 1 < heap.size() && less(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!less(heap[child], frame)) {
+            break;
+        }
+        place(position, heap[child]);
+        position = child;
+    }
+    place(position, frame);
+}
+
+void LruKPolicy::recordAccess(uint32_t index, uint64_t now) {
+    if (now - lastAccess[index] > correlatedPeriod) {
+        // Close the correlated period of the previous reference: shift the
+        // history by its length, so that a burst counts as a single access.
+        uint64_t* hist = &history[index * k];
+        uint64_t correlation = lastAccess[index] - hist[0];
+        for (size_t i = k - 1; i > 0; i--) {
+            hist[i] = (hist[i - 1] == 0) ? 0 : hist[i - 1] + correlation;
+        }
+        hist[0] = now;
+    }
+    lastAccess[index] = now;
+}
+
+void LruKPolicy::on_admit(BufferFrame& frame) {
+    uint32_t index = &frame - frames;
+    uint64_t now = ++clock;
+    auto entry = retained.find(frame.getPageId());
+    if (entry != retained.end()) {
+        uint32_t slot = entry->second;
+        std::copy_n(retainedHistory.begin() + slot * k, k, history.begin() + index * k);
+        lastAccess[index] = history[index * k];
+        recordAccess(index, now);
+        retainedPageIds[slot] = INVALID_PAGE_ID;
+        retained.erase(entry);
+    } else {
+        std::fill_n(history.begin() + index * k, k, 0);
+        history[index * k] = now;
+        lastAccess[index] = now;
+    }
+    heap.push_back(index);
+    heapPosition[index] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+}
+
+void LruKPolicy::on_hit(BufferFrame& frame) {
+    uint32_t index = &frame - frames;
+    recordAccess(index, ++clock);
+    // Keys only grow.
+    siftDown(heapPosition[index]);
+}
+
+BufferFrame* LruKPolicy::pick_victim(uint64_t, const VictimFilter& filter) {
+    // Best-first search from the root: a frame's children only become
+    // candidates once the frame itself has been passed over. Frames inside
+    // their correlated period are only offered to the filter once no other
+    // frame was accepted.
+    if (heap.empty()) {
+        return nullptr;
+    }
+    auto byKey = [this](size_t a, size_t b) { return less(heap[b], heap[a]); };
+    std::vector<size_t> candidates{0};
+    std::vector<uint32_t> correlated;
+    while (!candidates.empty()) {
+        std::pop_heap(candidates.begin(), candidates.end(), byKey);
+        size_t position = candidates.back();
+        candidates.pop_back();
+        uint32_t index = heap[position];
+        if (clock - lastAccess[index] <= correlatedPeriod) {
+            correlated.push_back(index);
+        } else if (filter(frames[index])) {
+            return &frames[index];
+        }
+        for (size_t child = 2 * position + 1; child <= 2 * position + 2; child++) {
+            if (child < heap.size()) {
+                candidates.push_back(child);
+                std::push_heap(candidates.begin(), candidates.end(), byKey);
+            }
+        }
+    }
+    for (uint32_t index : correlated) {
+        if (filter(frames[index])) {
+            return &frames[index];
+        }
+    }
+    return nullptr;
+}
+
+void LruKPolicy::on_evict(BufferFrame& frame) {
+    uint32_t index = &frame - frames;
+    size_t position = heapPosition[index];
+    heapPosition[index] = NOT_IN_HEAP;
+    uint32_t last = heap.back();
+    heap.pop_back();
+    if (position != heap.size()) {
+        place(position, last);
+        siftUp(position);
+        siftDown(heapPosition[last]);
+    }
+
+    size_t slot = nextRetained;
+    nextRetained = (nextRetained + 1) % retainedPageIds.size();
+    if (retainedPageIds[slot] != INVALID_PAGE_ID) {
+        retained.erase(retainedPageIds[slot]);
+    }
+    retainedPageIds[slot] = frame.getPageId();
+    std::copy_n(history.begin() + index * k, k, retainedHistory.begin() + slot * k);
+    retained[frame.getPageId()] = slot;
+}
+
+std::vector<BufferFrame*> LruKPolicy::sortedFrames(bool complete_history) const {
+    std::vector<uint32_t> indexes;
+    for (uint32_t index : heap) {
+        if ((kthAccess(index) != 0) == complete_history) {
+            indexes.push_back(index);
+        }
+    }
+    std::sort(indexes.begin(), indexes.end(),
+              [this](uint32_t a, uint32_t b) { return less(a, b); });
+    std::vector<BufferFrame*> result;
+    result.reserve(indexes.size());
+    for (uint32_t index : indexes) {
+        result.push_back(&frames[index]);
+    }
+    return result;
+}
+
+std::vector<BufferFrame*> LruKPolicy::get_fifo_list() const {
+    return sortedFrames(false);
+}
+
+std::vector<BufferFrame*> LruKPolicy::get_lru_list() const {
+    return sortedFrames(true);
+}
+
+}  // namespace buzzdb
@@ -0,0 +1,70 @@
+#include "buffer/page_table.h"
+#include <cassert>
+
+namespace buzzdb {
+
+PageTable::PageTable(size_t max_entries) {
+    // Keep the load factor at or below 50% so probe sequences stay short.
+    size_t capacity = 16;
+    while (capacity < 2 * max_entries) {
+        capacity *= 2;
+    }
+    slots = std::make_unique<Slot[]>(capacity);
+    mask = capacity - 1;
+    count = 0;
+}
+
+void PageTable::insert(uint64_t page_id, BufferFrame* frame) {
+    assert(page_id != INVALID_PAGE_ID);
+    assert(count < mask);
+    size_t i = hash(page_id) & mask;
+    while (slots[i].pageId.load(std::memory_order_relaxed) != INVALID_PAGE_ID) {
+        assert(slots[i].pageId.load(std::memory_order_relaxed) != page_id);
+        i = (i + 1) & mask;
+    }
+    // Publish the frame before the key so a concurrent lookup that sees the
+    // key also sees the frame.
+    slots[i].frame.store(frame, std::memory_order_relaxed);
+    slots[i].pageId.store(page_id, std::memory_order_release);
+    count++;
+}
+
+bool PageTable::erase(uint64_t page_id) {
+    size_t i = hash(page_id) & mask;
+    while (true) {
+        uint64_t key = slots[i].pageId.load(std::memory_order_relaxed);
+        if (key == page_id) {
+            break;
+        }
+        if (key == INVALID_PAGE_ID) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Backward-shift deletion: move every following entry of the cluster
+    // whose home slot does not lie cyclically in (i, j] into the hole.
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        uint64_t key = slots[j].pageId.load(std::memory_order_relaxed);
+        if (key == INVALID_PAGE_ID) {
+            break;
+        }
+        size_t home = hash(key) & mask;
+        bool inRange = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (inRange) {
+            continue;
+        }
+        slots[i].frame.store(slots[j].frame.load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+        slots[i].pageId.store(key, std::memory_order_release);
+        i = j;
+    }
+    slots[i].pageId.store(INVALID_PAGE_ID, std::memory_order_release);
+    slots[i].frame.store(nullptr, std::memory_order_relaxed);
+    count--;
+    return true;
+}
+
+}  // namespace buzzdb
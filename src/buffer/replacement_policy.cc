@@ -0,0 +1,32 @@
+#include "buffer/replacement_policy.h"
+#include <stdexcept>
+#include "buffer/arc_policy.h"
+#include "buffer/buffer_manager.h"
+#include "buffer/clock_policy.h"
+#include "buffer/lru_k_policy.h"
+#include "buffer/sampled_lru_policy.h"
+#include "buffer/two_queue_policy.h"
+
+namespace buzzdb {
+
+std::unique_ptr<ReplacementPolicy> ReplacementPolicy::create(const BufferManagerOptions& options,
+                                                             BufferFrame* frames,
+                                                             size_t frame_count) {
+    switch (options.replacement_policy) {
+        case ReplacementPolicyType::TWO_QUEUE:
+            return std::make_unique<TwoQueuePolicy>(frames, frame_count);
+        case ReplacementPolicyType::CLOCK:
+            return std::make_unique<ClockPolicy>(frames, frame_count);
+        case ReplacementPolicyType::ARC:
+            return std::make_unique<ArcPolicy>(frames, frame_count);
+        case ReplacementPolicyType::LRU_K:
+            return std::make_unique<LruKPolicy>(frames, frame_count, options.lru_k,
+                                                options.lru_k_correlated_period);
+        case ReplacementPolicyType::SAMPLED_LRU:
+            return std::make_unique<SampledLruPolicy>(frames, frame_count,
+                                                      options.sampled_lru_sample_size);
+    }
+    throw std::invalid_argument{"unknown replacement policy"};
+}
+
+}  // namespace buzzdb
@@ -0,0 +1,111 @@
+#include "buffer/sampled_lru_policy.h"
+#include <algorithm>
+#include <utility>
+#include "buffer/buffer_manager.h"
+
+namespace buzzdb {
+
+SampledLruPolicy::SampledLruPolicy(BufferFrame* frames, size_t frame_count, size_t sample_size)
+    : frames(frames), sampleSize(sample_size), clock(0),
+      lastAccess(std::make_unique<std::atomic<uint64_t>[]>(frame_count)),
+      residentPosition(frame_count, NOT_RESIDENT),
+      random(0x9e3779b97f4a7c15ull ^ reinterpret_cast<uintptr_t>(frames)) {
+    resident.reserve(frame_count);
+    for (size_t i = 0; i < frame_count; i++) {
+        lastAccess[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t SampledLruPolicy::nextRandom() {
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    return random;
+}
+
+void SampledLruPolicy::on_admit(BufferFrame& frame) {
+    uint32_t index = &frame - frames;
+    residentPosition[index] = resident.size();
+    resident.push_back(index);
+    uint64_t now = clock.load(std::memory_order_relaxed) + 1;
+    clock.store(now, std::memory_order_relaxed);
+    lastAccess[index].store(now, std::memory_order_relaxed);
+}
+
+void SampledLruPolicy::on_hit(BufferFrame& frame) {
+    // Check first so that hot pages do not keep dirtying the cache line.
+    uint64_t now = clock.load(std::memory_order_relaxed);
+    std::atomic<uint64_t>& stamp = lastAccess[&frame - frames];
+    if (stamp.load(std::memory_order_relaxed) != now) {
+        stamp.store(now, std::memory_order_relaxed);
+    }
+}
+
+BufferFrame* SampledLruPolicy::pick_victim(uint64_t, const VictimFilter& filter) {
+    if (resident.empty()) {
+        return nullptr;
+    }
+    // The filter sees every frame at most once and each sample least
+    // recently used first, like the candidates of an ordered policy.
+    std::vector<uint32_t> rejected;
+    auto pickOldest = [&](std::vector<uint32_t>& sample) -> BufferFrame* {
+        std::sort(sample.begin(), sample.end());
+        sample.erase(std::unique(sample.begin(), sample.end()), sample.end());
+        std::vector<std::pair<uint64_t, uint32_t>> order;
+        order.reserve(sample.size());
+        for (uint32_t index : sample) {
+            if (!std::binary_search(rejected.begin(), rejected.end(), index)) {
+                order.emplace_back(lastAccess[index].load(std::memory_order_relaxed), index);
+            }
+        }
+        std::sort(order.begin(), order.end());
+        for (auto [stamp, index] : order) {
+            if (filter(frames[index])) {
+                return &frames[index];
+            }
+            rejected.insert(std::lower_bound(rejected.begin(), rejected.end(), index), index);
+        }
+        return nullptr;
+    };
+
+    // Pinned frames are rare, so a few samples almost always find a victim.
+    constexpr size_t maxRounds = 4;
+    std::vector<uint32_t> sample;
+    for (size_t round = 0; round < maxRounds; round++) {
+        sample.clear();
+        for (size_t i = 0; i < sampleSize; i++) {
+            sample.push_back(resident[nextRandom() % resident.size()]);
+        }
+        if (BufferFrame* victim = pickOldest(sample)) {
+            return victim;
+        }
+    }
+    sample = resident;
+    return pickOldest(sample);
+}
+
+void SampledLruPolicy::on_evict(BufferFrame& frame) {
+    uint32_t index = &frame - frames;
+    uint32_t position = residentPosition[index];
+    uint32_t last = resident.back();
+    resident[position] = last;
+    residentPosition[last] = position;
+    resident.pop_back();
+    residentPosition[index] = NOT_RESIDENT;
+}
+
+std::vector<BufferFrame*> SampledLruPolicy::get_fifo_list() const {
+    std::vector<uint32_t> order = resident;
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return lastAccess[a].load(std::memory_order_relaxed) <
+            lastAccess[b].load(std::memory_order_relaxed);
+    });
+    std::vector<BufferFrame*> result;
+    result.reserve(order.size());
+    for (uint32_t index : order) {
+        result.push_back(&frames[index]);
+    }
+    return result;
+}
+
+}  // namespace buzzdb
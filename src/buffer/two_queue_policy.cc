@@ -0,0 +1,80 @@
+#include "buffer/two_queue_policy.h"
+#include "buffer/buffer_manager.h"
+
+namespace buzzdb {
+
+TwoQueuePolicy::TwoQueuePolicy(BufferFrame* frames, size_t frame_count)
+    : frames(frames), nodes(std::make_unique<Node[]>(frame_count)) {
+    for (size_t i = 0; i < frame_count; i++) {
+        nodes[i].frame = frames + i;
+    }
+}
+
+TwoQueuePolicy::Node& TwoQueuePolicy::getNode(BufferFrame& frame) {
+    return nodes[&frame - frames];
+}
+
+void TwoQueuePolicy::on_admit(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    fifoQueue.push_back(&node);
+    node.queue = Queue::FIFO;
+}
+
+void TwoQueuePolicy::on_hit(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    if (node.queue == Queue::LRU) {
+        lruQueue.move_to_back(&node);
+    } else {
+        fifoQueue.remove(&node);
+        lruQueue.push_back(&node);
+        node.queue = Queue::LRU;
+    }
+}
+
+void TwoQueuePolicy::on_unfix(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    if (node.queue == Queue::LRU) {
+        lruQueue.move_to_back(&node);
+    }
+}
+
+BufferFrame* TwoQueuePolicy::pick_victim(uint64_t, const VictimFilter& filter) {
+    for (auto* queue : {&fifoQueue, &lruQueue}) {
+        for (Node* node = queue->front(); node != nullptr;
+                node = IntrusiveList<Node>::next(node)) {
+            if (filter(*node->frame)) {
+                return node->frame;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void TwoQueuePolicy::on_evict(BufferFrame& frame) {
+    Node& node = getNode(frame);
+    if (node.queue == Queue::FIFO) {
+        fifoQueue.remove(&node);
+    } else {
+        lruQueue.remove(&node);
+    }
+    node.queue = Queue::NONE;
+}
+
+std::vector<BufferFrame*> TwoQueuePolicy::toFrames(const IntrusiveList<Node>& queue) {
+    std::vector<BufferFrame*> result;
+    result.reserve(queue.size());
+    for (Node* node = queue.front(); node != nullptr; node = IntrusiveList<Node>::next(node)) {
+        result.push_back(node->frame);
+    }
+    return result;
+}
+
+std::vector<BufferFrame*> TwoQueuePolicy::get_fifo_list() const {
+    return toFrames(fifoQueue);
+}
+
+std::vector<BufferFrame*> TwoQueuePolicy::get_lru_list() const {
+    return toFrames(lruQueue);
+}
+
+}  // namespace buzzdb
@@ -0,0 +1,66 @@
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+
+#include "common/hybrid_latch.h"
+
+namespace buzzdb {
+
+namespace {
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "the futex must alias the latch word");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "the futex must cover the low half of the latch word");
+
+/// Rounds of spinning before a waiter parks. A page latch is usually held
+/// for a few hundred nanoseconds at most, or for a whole read from disk.
+constexpr int SPIN_ROUNDS = 64;
+
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+uint32_t* futex_word(std::atomic<uint64_t>& word) {
+  return reinterpret_cast<uint32_t*>(&word);
+}
+
+}  // namespace
+
+void HybridLatch::wait(bool exclusive) {
+  uint64_t busy = exclusive ? (EXCLUSIVE | SHARED_MASK) : EXCLUSIVE;
+  for (int round = 0;; round++) {
+    if (exclusive ? try_lock() : try_lock_shared()) {
+      return;
+    }
+    if (round < SPIN_ROUNDS) {
+      cpu_relax();
+      continue;
+    }
+    uint64_t current = word.load(std::memory_order_relaxed);
+    if ((current & busy) == 0) {
+      continue;
+    }
+    if ((current & PARKED) == 0 &&
+        !word.compare_exchange_weak(current, current | PARKED,
+                                    std::memory_order_relaxed)) {
+      continue;
+    }
+    // Sleeps only if the low half still holds what was seen, so a release
+    // that cleared the flag in between is not missed.
+    ::syscall(SYS_futex, futex_word(word), FUTEX_WAIT_PRIVATE,
+              static_cast<uint32_t>(current | PARKED), nullptr, nullptr, 0);
+  }
+}
+
+void HybridLatch::wake() {
+  ::syscall(SYS_futex, futex_word(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+            nullptr, 0);
+}
+
+}  // namespace buzzdb
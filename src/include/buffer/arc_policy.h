@@ -0,0 +1,87 @@
+#ifndef ARC_POLICY_H_GUARD
+#define ARC_POLICY_H_GUARD
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "buffer/replacement_policy.h"
+#include "common/intrusive_list.h"
+
+namespace buzzdb {
+
+/// Adaptive Replacement Cache (Megiddo and Modha, FAST 2003).
+///
+/// Resident pages are split into T1 (seen once recently) and T2 (seen at
+/// least twice). The ids of pages recently evicted from them are remembered
+/// in the ghost lists B1 and B2. A miss on a page in B1 means T1 was too
+/// small and grows the target size `p` of T1; a miss on a page in B2 shrinks
+/// it. Victims come from T1 while it is larger than `p` and from T2
+/// otherwise, so the split follows the workload between recency and
+/// frequency. Ghost entries are trimmed so that |T1| + |B1| and |T2| + |B2|
+/// stay within the frame count.
+class ArcPolicy : public ReplacementPolicy {
+private:
+    enum class List : uint8_t { NONE, T1, T2 };
+
+    struct Node {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        List list = List::NONE;
+        BufferFrame* frame = nullptr;
+    };
+
+    struct Ghost {
+        /// Whether the page is in B2 rather than B1.
+        bool inB2;
+        std::list<uint64_t>::iterator position;
+    };
+
+    BufferFrame* frames;
+    size_t frameCount;
+    /// Node `i` belongs to frame `frames + i`.
+    std::unique_ptr<Node[]> nodes;
+    /// Resident pages, least recently used first.
+    IntrusiveList<Node> t1;
+    IntrusiveList<Node> t2;
+    /// Ghost page ids, least recently evicted first.
+    std::list<uint64_t> b1;
+    std::list<uint64_t> b2;
+    std::unordered_map<uint64_t, Ghost> ghosts;
+    /// Target size of T1.
+    size_t target;
+
+    Node& getNode(BufferFrame& frame);
+
+    /// Returns the target size of T1 after a miss on `page_id`.
+    size_t adaptTarget(uint64_t page_id) const;
+
+    void dropGhost(std::list<uint64_t>& list);
+
+    static std::vector<BufferFrame*> toFrames(const IntrusiveList<Node>& list);
+
+public:
+    ArcPolicy(BufferFrame* frames, size_t frame_count);
+
+    void on_admit(BufferFrame& frame) override;
+
+    void on_hit(BufferFrame& frame) override;
+
+    BufferFrame* pick_victim(uint64_t incoming_page_id, const VictimFilter& filter) override;
+
+    void on_evict(BufferFrame& frame) override;
+
+    /// Returns T1.
+    std::vector<BufferFrame*> get_fifo_list() const override;
+
+    /// Returns T2.
+    std::vector<BufferFrame*> get_lru_list() const override;
+
+    /// Returns the current target size of T1.
+    size_t get_target() const {
+        return target;
+    }
+};
+
+}  // namespace buzzdb
+
+#endif
@@ -1,65 +1,195 @@
 #ifndef BUFFER_MANAGER_H_GUARD
 #define BUFFER_MANAGER_H_GUARD
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <exception>
+#include <memory>
 #include <vector>
-#include <map>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include "buffer/frequency_sketch.h"
+#include "buffer/page_table.h"
+#include "buffer/replacement_policy.h"
+#include "common/hybrid_latch.h"
+#include "storage/file_cache.h"
 
 namespace buzzdb {
 
 class BufferFrame {
 private:
     friend class BufferManager;
+
+    /// Who tracks the frame.
+    enum class Residency : uint8_t {
+        /// The frame holds no page and is on the free list.
+        FREE,
+        /// The page was admitted to the replacement policy.
+        POLICY,
+        /// The page was turned away by the admission filter and waits in the
+        /// probation ring.
+        PROBATION,
+        /// The frame belongs to the ring of a `ScanStrategy`.
+        RING,
+        /// The policy gave up the page, which waits in the cooling FIFO to
+        /// be evicted unless it is used again.
+        COOLING,
+    };
+
+    /// Bits of `state`.
+    static constexpr uint64_t PIN_MASK = (uint64_t{1} << 32) - 1;
+    /// The page was modified since it was last written to disk.
+    static constexpr uint64_t DIRTY = uint64_t{1} << 32;
+    /// An evictor claimed the unfixed frame, or the frame is free. The frame
+    /// cannot be fixed until it holds a new page.
+    static constexpr uint64_t EVICTING = uint64_t{1} << 33;
+    /// The frame was given its page, but the page has not been read yet.
+    /// Set by `reset()` and cleared under the exclusive latch once the read
+    /// succeeded, so a fixer that finds it still set after latching the
+    /// frame knows that the read failed.
+    static constexpr uint64_t LOADING = uint64_t{1} << 34;
+
     uint64_t pageId;
     uint64_t pageSize;
-    int64_t counter;
-    bool mIsExclusive;
-    bool mIsDirty;
-    std::vector<char> data;
+    /// Fix count in the low 32 bits plus the flags above, packed so that a
+    /// fix, an unfix together with marking the page dirty, or an eviction
+    /// claim each take a single atomic operation. A frame is fixed without
+    /// any partition latch; an evictor claims it only while it is unfixed,
+    /// and a fix fails while it is claimed, so a fixed frame keeps its page.
+    std::atomic<uint64_t> state;
+    /// Points into the buffer manager's frame arena.
+    char* data;
+
+    /// Index of the partition that owns this frame.
+    uint32_t partition;
+    /// Changes only while the partition latch is held exclusively.
+    std::atomic<Residency> residency;
+    /// Set when a ring frame is fixed without its scan strategy or a cooling
+    /// frame is fixed at all, so that the page goes back to the policy
+    /// instead of being evicted.
+    std::atomic<bool> touched;
+
+    /// Page latch. Its version is odd while the latch is held exclusively,
+    /// which includes the time the frame is given another page, so
+    /// optimistic readers can tell whether the frame changed under them.
+    mutable HybridLatch latch;
+
+    /// Prepares a free or claimed frame to hold `page_id`. The caller must
+    /// hold `latch` exclusively; the frame is then fixed once and loading.
+    /// Releasing the latch after loading the page makes the version even
+    /// again.
+    void reset(uint64_t page_id);
+
+    /// Fixes the frame unless it is claimed for eviction or free.
+    bool tryPin() {
+        uint64_t current = state.load(std::memory_order_relaxed);
+        do {
+            if ((current & EVICTING) != 0) {
+                return false;
+            }
+        } while (!state.compare_exchange_weak(current, current + 1, std::memory_order_acquire,
+                                              std::memory_order_relaxed));
+        return true;
+    }
+
+    /// Unfixes the frame and, if `is_dirty`, marks it dirty in the same
+    /// step, so that an evictor never sees it unfixed but not yet dirty.
+    /// Returns whether the page became dirty.
+    bool unpin(bool is_dirty) {
+        if (!is_dirty) {
+            state.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+        uint64_t current = state.load(std::memory_order_relaxed);
+        while (!state.compare_exchange_weak(current, (current - 1) | DIRTY,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+        return (current & DIRTY) == 0;
+    }
 
-    mutable std::shared_mutex pageMutex;
+    /// Claims the frame for eviction if nobody has it fixed.
+    bool tryClaim() {
+        uint64_t current = state.load(std::memory_order_relaxed);
+        do {
+            if ((current & (PIN_MASK | EVICTING)) != 0) {
+                return false;
+            }
+        } while (!state.compare_exchange_weak(current, current | EVICTING,
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed));
+        return true;
+    }
+
+    /// Gives up a claim when the frame is not evicted after all.
+    void releaseClaim() {
+        state.fetch_and(~EVICTING, std::memory_order_release);
+    }
+
+    /// Returns whether the page has not been read yet.
+    bool isLoading() const {
+        return (state.load(std::memory_order_acquire) & LOADING) != 0;
+    }
+
+    /// Marks the page as read. The caller holds the latch exclusively.
+    void finishLoading() {
+        state.fetch_and(~LOADING, std::memory_order_release);
+    }
+
+    /// Clears the dirty flag. Returns whether it was set.
+    bool markClean() {
+        return (state.fetch_and(~DIRTY, std::memory_order_relaxed) & DIRTY) != 0;
+    }
 
 public:
-    BufferFrame(const uint64_t page_id, const uint64_t page_size, const int64_t counter = 0,
-            const bool is_exclusive = false, const bool is_dirty = false
-    );
+    BufferFrame();
 
     ~BufferFrame();
 
     /// Returns a pointer to this page's data.
     char* get_data();
 
-    bool isDirty() {
-        return mIsDirty;
+    /// Returns the id of the page in this frame.
+    uint64_t getPageId() const {
+        return pageId;
+    }
+
+    /// Returns whether the page was modified since it was last written to
+    /// disk.
+    bool isDirty() const {
+        return (state.load(std::memory_order_relaxed) & DIRTY) != 0;
     }
 
-    void readDisk();
+    /// Reads the page from its segment file.
+    void readDisk(File& file);
 
-    void writeDisk();
+    /// Writes the page to its segment file.
+    void writeDisk(File& file);
 
     void lockPage(const bool exclusive);
 
-    void unlockPage(const bool is_dirty);
+    void unlockPage();
 
-    int64_t getCounter() {
-        return counter;
+    int64_t getCounter() const {
+        return state.load(std::memory_order_relaxed) & PIN_MASK;
     }
 
     void incCounter() {
-        counter++;
+        state.fetch_add(1, std::memory_order_relaxed);
     }
 
     void decCounter() {
-        counter--;
+        state.fetch_sub(1, std::memory_order_relaxed);
     }
 };
 
 
-
 class buffer_full_error
 : public std::exception {
 public:
@@ -68,36 +198,371 @@ public:
     }
 };
 
+/// Bounds on the number of frames that pages of one segment may occupy.
+struct SegmentQuota {
+    /// Frames reserved for the segment. Pages of other segments do not
+    /// evict its pages while it holds no more than this many.
+    size_t min_frames = 0;
+    /// Frames the segment may hold at most. When it holds this many, a miss
+    /// on one of its pages evicts another of its pages.
+    size_t max_frames = SIZE_MAX;
+};
+
+/// Tuning knobs of a `BufferManager` that have sensible defaults.
+struct BufferManagerOptions {
+    /// Number of independent partitions. Page ids are hashed to partitions;
+    /// every partition owns an equal share of the frames together with its
+    /// own page table, replacement queues and latches, so fixes of pages in
+    /// different partitions never contend. With one partition the manager
+    /// behaves like a single global pool.
+    size_t partition_count = 1;
+    /// Number of segment files that are kept open at the same time. When
+    /// more segments are in use, the least recently used file is closed.
+    size_t max_open_files = 64;
+    /// Opens the file of a segment. When empty, segment `i` is stored in a
+    /// file named `i` in the working directory, opened according to
+    /// `direct_io` and `sync_each_write`. Tools that only exercise the
+    /// replacement logic can pass files that are not backed by storage.
+    FileCache::Opener file_opener;
+    /// Policy that picks the pages to evict. See `ReplacementPolicyType`.
+    ReplacementPolicyType replacement_policy = ReplacementPolicyType::TWO_QUEUE;
+    /// Number of accesses LRU-K remembers per page.
+    size_t lru_k = 2;
+    /// Number of accesses to a partition after an access to a page during
+    /// which further accesses to that page count as the same reference for
+    /// LRU-K.
+    uint64_t lru_k_correlated_period = 0;
+    /// Number of frames sampled per eviction by the sampled LRU policy.
+    /// Larger samples come closer to exact LRU and cost more per miss.
+    size_t sampled_lru_sample_size = 5;
+    /// Puts a TinyLFU admission filter in front of the replacement policy.
+    /// A page that misses replaces the policy's victim only when a frequency
+    /// sketch estimates it as accessed more often. Otherwise it goes into a
+    /// small probation ring of frames. When the ring is full, its oldest
+    /// page is dropped, or admitted in place of the policy's victim if it
+    /// has become more popular meanwhile.
+    bool admission_filter = false;
+    /// Share of a partition's frames that the probation ring may use.
+    double admission_probation_ratio = 0.01;
+    /// Share of a partition's frames that is kept in a cooling stage, as in
+    /// LeanStore. Pages the policy picks as victims first move to a cooling
+    /// FIFO, where they stay resident. A fix rescues a cooling page back to
+    /// the policy by setting a flag. When the free list runs empty, it is
+    /// refilled in one batch from the cold end of the FIFO, and the FIFO is
+    /// then topped up from the policy, so most misses just pop a free frame.
+    /// Zero disables the cooling stage. Cannot be combined with the
+    /// admission filter.
+    double cooling_ratio = 0.0;
+    /// With the cooling stage, share of a partition's frames that each refill
+    /// of the free list frees.
+    double free_frames_ratio = 0.02;
+    /// Frame quotas by segment id. Segments without an entry are unbounded.
+    /// Quotas are split evenly across partitions and enforced per
+    /// partition during victim selection, rounding reservations up and caps
+    /// down (but to at least one frame). Pages loaded into the ring of a
+    /// `ScanStrategy` count towards their segment, but the ring recycles its
+    /// own frames regardless of quotas.
+    std::unordered_map<uint16_t, SegmentQuota> segment_quotas;
+    /// Opens segment files with O_DIRECT, so pages are cached in the buffer
+    /// pool only and not a second time in the kernel page cache. The page
+    /// size must then be a multiple of `File::DIRECT_IO_ALIGNMENT`.
+    bool direct_io = false;
+    /// Opens segment files with O_SYNC, so that every page write waits for
+    /// the device. When false, page writes only reach the OS and become
+    /// durable with `BufferManager::flush_all()` (or the destructor), which
+    /// issue a single fdatasync per segment.
+    bool sync_each_write = true;
+    /// Starts a background thread that writes dirty, unfixed pages to disk
+    /// ahead of eviction, so that `fix_page()` usually finds clean victims.
+    bool background_writer = false;
+    /// Fraction of dirty frames at which the background writer starts. It
+    /// then writes pages in eviction order until half that fraction is left.
+    double background_writer_dirty_ratio = 0.1;
+    /// Longest time the background writer sleeps between two checks of the
+    /// dirty ratio.
+    std::chrono::milliseconds background_writer_interval{100};
+    /// Number of unfixed eviction candidates the buffer manager looks at to
+    /// find a clean victim. The first clean candidate in eviction order is
+    /// evicted; when all of them are dirty, the last one is. Skipped dirty
+    /// candidates are handed to a background thread that writes them, so
+    /// that they are clean when eviction reaches them again. Zero or one
+    /// evicts the first candidate.
+    size_t clean_victim_window = 0;
+};
+
+/// Counters describing the work a `BufferManager` did so far.
+struct BufferManagerStats {
+    /// Fixes that had to read the page from disk.
+    uint64_t misses = 0;
+    /// Dirty pages written to disk.
+    uint64_t writebacks = 0;
+    /// Evictions of clean pages that did not need a write.
+    uint64_t writebacks_avoided = 0;
+    /// Misses that the admission filter sent to the probation ring.
+    uint64_t admissions_rejected = 0;
+    /// Cooling pages that were used again and went back to the policy.
+    uint64_t cooling_rescues = 0;
+    /// Write-backs done by the background writer. Included in `writebacks`.
+    uint64_t background_writebacks = 0;
+    /// Write-backs of victims that a miss had to wait for. Included in
+    /// `writebacks`.
+    uint64_t foreground_writebacks = 0;
+    /// Dirty candidates that eviction skipped in favor of a clean one.
+    uint64_t dirty_victims_skipped = 0;
+    /// Fixes of a page that another fix was still reading. They waited for
+    /// that read instead of issuing their own. Not included in `misses`.
+    uint64_t coalesced_misses = 0;
+};
+
+class BufferManager;
+
+/// Access strategy for sequential scans, like PostgreSQL's
+/// BufferAccessStrategy. Pages that a scan fixes through the strategy and
+/// that are not resident yet are loaded into a small private ring of frames.
+/// Once the ring is full, the scan recycles the ring's frames instead of
+/// evicting pages of the main pool, so a large scan does not push out the
+/// working set. Pages that are already resident are used as they are.
+///
+/// A ring frame whose page is fixed or was fixed by someone else since it
+/// was loaded is handed to the replacement policy when the scan comes
+/// around, and a fresh frame takes its place. On destruction all ring frames
+/// are handed to the policy, so the last pages of the scan stay cached.
+///
+/// A strategy must only be used by one thread at a time and must not outlive
+/// its buffer manager.
+class ScanStrategy {
+private:
+    friend class BufferManager;
+
+    struct Ring {
+        std::vector<BufferFrame*> frames;
+        /// Index of the frame to recycle next.
+        size_t next = 0;
+    };
+
+    BufferManager& bufferManager;
+    /// Maximum number of frames per partition.
+    size_t ringSize;
+    /// One ring per partition of the buffer manager.
+    std::vector<Ring> rings;
+
+public:
+    /// Number of frames used by default, as in PostgreSQL's bulk read ring.
+    static constexpr size_t DEFAULT_RING_SIZE = 32;
+
+    /// Constructor.
+    /// @param[in] buffer_manager The buffer manager the scan goes through.
+    /// @param[in] ring_size      Number of frames the ring takes at most. With
+    ///                           several partitions, every partition gets an
+    ///                           equal share, but at least one frame.
+    explicit ScanStrategy(BufferManager& buffer_manager, size_t ring_size = DEFAULT_RING_SIZE);
+
+    ScanStrategy(const ScanStrategy&) = delete;
+    ScanStrategy& operator=(const ScanStrategy&) = delete;
+
+    /// Destructor. Hands the ring's frames to the replacement policy.
+    ~ScanStrategy();
+};
+
 class BufferManager {
 private:
+    friend class ScanStrategy;
+
+    /// Alignment of the frame arena and thereby of the first page. With a
+    /// suitable page size every frame is then aligned for direct I/O.
+    static constexpr size_t FRAME_ALIGNMENT = File::DIRECT_IO_ALIGNMENT;
+
+    /// A slice of the buffer pool that is managed independently.
+    struct alignas(64) Partition {
+        /// Frames of this partition that do not hold a page.
+        std::vector<BufferFrame*> freeFrames;
+        /// Tracks the frames that hold pages and picks victims among them.
+        std::unique_ptr<ReplacementPolicy> policy;
+        /// Access frequencies for the admission filter, if enabled.
+        std::unique_ptr<FrequencySketch> sketch;
+        /// Frames of pages that the admission filter turned away, oldest
+        /// first.
+        std::deque<BufferFrame*> probation;
+        size_t probationLimit = 0;
+        /// Pages the policy gave up, oldest first. See
+        /// `BufferManagerOptions::cooling_ratio`.
+        std::deque<BufferFrame*> cooling;
+        size_t coolingTarget = 0;
+        size_t freeTarget = 0;
+        /// This partition's share of a segment's quota and the segment's
+        /// resident pages in this partition.
+        struct QuotaState {
+            size_t minFrames;
+            size_t maxFrames;
+            size_t resident = 0;
+        };
+        std::unordered_map<uint16_t, QuotaState> quotas;
+        PageTable pageTable;
+        /// Guards `pageTable` and `freeFrames`. Held exclusively while pages
+        /// are added or evicted and shared by background writers. Hits look
+        /// pages up without it.
+        mutable std::shared_mutex managerMutex;
+        /// Guards the replacement policy and the probation ring.
+        mutable std::shared_mutex queueMutex;
+
+        explicit Partition(size_t frame_count) : pageTable(frame_count) {}
+    };
+
     size_t pageSize;
     size_t pageCount;
-    std::vector<uint64_t> fifoQueue;
-    std::vector<uint64_t> lruQueue;
-    std::map<uint64_t, BufferFrame*> bufferMapping;
-    mutable std::shared_mutex managerMutex;
-    mutable std::shared_mutex queueMutex;
+    /// Page memory of all frames, allocated once in the constructor.
+    char* frameMemory;
+    /// Frame descriptors. Frame `i` owns the `i`-th page of `frameMemory`.
+    std::unique_ptr<BufferFrame[]> frames;
+    std::vector<std::unique_ptr<Partition>> partitions;
+    /// Open segment files, shared by all frames.
+    FileCache fileCache;
+
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> writebacks{0};
+    std::atomic<uint64_t> writebacksAvoided{0};
+    std::atomic<uint64_t> admissionsRejected{0};
+    std::atomic<uint64_t> coolingRescues{0};
+    std::atomic<uint64_t> backgroundWritebacks{0};
+    std::atomic<uint64_t> foregroundWritebacks{0};
+    std::atomic<uint64_t> dirtyVictimsSkipped{0};
+    std::atomic<uint64_t> coalescedMisses{0};
+    /// Resident pages of segment `i`.
+    std::unique_ptr<std::atomic<size_t>[]> segmentResidency;
+
+    /// Approximate number of dirty frames. Updated with relaxed atomics and
+    /// without any latch, so it may briefly lag behind the frames' flags.
+    std::atomic<size_t> dirtyFrames{0};
+    /// `dirtyFrames` value at which the background writer starts.
+    size_t dirtyFramesHigh;
+    /// `dirtyFrames` value at which the background writer stops.
+    size_t dirtyFramesLow;
+    std::chrono::milliseconds writerInterval;
+    /// Whether the writer thread writes pages when the dirty ratio is high.
+    bool flushOnDirtyRatio;
+    size_t cleanVictimWindow;
+    bool syncEachWrite;
+    /// Segments written since the last `flush_all()` that may still need an
+    /// fdatasync.
+    std::vector<bool> unsyncedSegments;
+    std::mutex unsyncedMutex;
+    std::thread writerThread;
+    std::mutex writerMutex;
+    std::condition_variable writerCondition;
+    bool writerStop = false;
+    /// Pages that eviction skipped because they were dirty. Guarded by
+    /// `writerMutex`.
+    std::vector<uint64_t> writeRequests;
+
+    size_t getPartitionIndex(uint64_t page_id) const {
+        // Use the high half of the hash; the page table indexes with the
+        // low bits, which are then still evenly spread within a partition.
+        uint64_t hash = PageTable::hash(page_id) >> 32;
+        return (hash * partitions.size()) >> 32;
+    }
+
+    Partition& getPartition(uint64_t page_id) {
+        return *partitions[getPartitionIndex(page_id)];
+    }
+
+    void readPage(BufferFrame& frame);
+    /// Reads the page of a loading frame that the caller has fixed and
+    /// latched exclusively, then leaves it latched as `exclusive` asks. When
+    /// the read fails, the frame is unlatched, unfixed and stays loading, so
+    /// the next fix reads it again; the exception is passed on.
+    void loadPage(BufferFrame& frame, bool exclusive);
+    /// Latches a frame that the caller has fixed on a hit. A page that is
+    /// still being read is waited for; one whose read failed is read again.
+    BufferFrame& latchResidentPage(BufferFrame& frame, bool exclusive);
+    void writePage(BufferFrame& frame);
+    /// Clears the dirty flag after a write-back.
+    void markClean(BufferFrame& frame);
+
+    /// Writes a dirty frame that the caller has fixed and unfixes it again.
+    /// Holds the page latch shared during the write, so the page is clean
+    /// afterwards. When the write fails, the frame stays dirty and the
+    /// exception is passed on.
+    void writeFixedPage(BufferFrame& frame);
+
+    void runBackgroundWriter();
+    /// Writes dirty, unfixed pages of `partition` in eviction order until
+    /// the dirty count reaches `dirtyFramesLow`. Returns the number of pages
+    /// written.
+    size_t flushPartition(Partition& partition);
+    /// Writes the pages in `page_ids` that are still resident, dirty and
+    /// unfixed, fixing one page at a time. Returns the number of pages
+    /// written.
+    size_t writeRequestedPages(const std::vector<uint64_t>& page_ids);
+
+    /// Returns whether the segment of `page_id` holds as many frames of the
+    /// partition as its quota allows.
+    bool segmentAtCap(const Partition& partition, uint64_t page_id) const;
+    /// Updates the residency counts of the segment of `page_id` after one of
+    /// its pages was added (`delta` = 1) or evicted (`delta` = -1).
+    void countResident(Partition& partition, uint64_t page_id, int delta);
+    /// Asks the policy for an unfixed victim that segment quotas allow to
+    /// make room for `page_id`, preferring clean ones within
+    /// `cleanVictimWindow` candidates, and claims it. Returns nullptr when
+    /// there is none.
+    BufferFrame* getPageToRemove(Partition& partition, uint64_t page_id);
+    /// Writes `victim` back if it is dirty and removes its page from the
+    /// partition. The frame must be claimed and stays claimed, so it can be
+    /// reused right away or put on the free list. When the write fails, the
+    /// claim is released and the exception passed on.
+    void evictPage(Partition& partition, BufferFrame& victim);
+    /// Refills the free list from the cooling FIFO and tops the FIFO up from
+    /// the policy.
+    void refillFreeFrames(Partition& partition, uint64_t page_id);
+    /// Returns a free frame, or else evicts the policy's victim and returns
+    /// its frame. Throws `buffer_full_error` when every page the policy
+    /// tracks is fixed.
+    BufferFrame* takeFrame(Partition& partition, uint64_t page_id);
+    /// Loads `page_id` into the next frame of the scan's ring, see
+    /// `ScanStrategy`.
+    BufferFrame* addRingPage(Partition& partition, uint64_t page_id, ScanStrategy& strategy);
+    /// Hands a frame that is not tracked by the policy to it.
+    void admitToPolicy(Partition& partition, BufferFrame& frame);
+    /// Evicts a page to make room for `page_id` and loads it into the freed
+    /// frame. Goes through the admission filter if there is one. Throws
+    /// `buffer_full_error` when every page of the partition is fixed.
+    BufferFrame* replacePage(Partition& partition, uint64_t page_id);
+    /// Records a fix of the resident page in `frame`, which the caller has
+    /// already pinned.
+    void updateExistingPage(Partition& partition, BufferFrame& frame, ScanStrategy* strategy);
+    BufferFrame& fixPage(uint64_t page_id, bool exclusive, ScanStrategy* strategy);
+    BufferFrame* addNewPage(Partition& partition, uint64_t page_id, BufferFrame& frame,
+                            BufferFrame::Residency residency = BufferFrame::Residency::POLICY);
 
 public:
     /// Constructor.
     /// @param[in] page_size  Size in bytes that all pages will have.
     /// @param[in] page_count Maximum number of pages that should reside in
     //                        memory at the same time.
-    BufferManager(size_t page_size, size_t page_count);
-
-    int getPageIndexToRemove(bool isFifo);
-    BufferFrame& removePage(uint64_t page_id, int indexToRemove, bool exclusive, bool isFifo);
-    BufferFrame& updateExistingPage(uint64_t page_id, bool exclusive);
-    BufferFrame& addNewPage(uint64_t page_id, bool exclusive);
+    /// @param[in] options    See `BufferManagerOptions`. Throws
+    ///                       `std::invalid_argument` when the partition count
+    ///                       is zero or larger than `page_count`, when
+    ///                       direct I/O is requested with an unaligned page
+    ///                       size, when `lru_k` is zero for LRU-K or
+    ///                       `sampled_lru_sample_size` is zero for sampled
+    ///                       LRU, when the probation ring or the cooling
+    ///                       stage would take all frames of a partition, or
+    ///                       when both the admission filter and cooling are
+    ///                       enabled, or when segment quotas are
+    ///                       inconsistent or reserve all frames of a
+    ///                       partition.
+    BufferManager(size_t page_size, size_t page_count,
+                  const BufferManagerOptions& options = BufferManagerOptions());
 
-    /// Destructor. Writes all dirty pages to disk.
+    /// Destructor. Stops the background writer and writes all dirty pages to
+    /// disk.
     ~BufferManager();
 
     /// Returns a reference to a `BufferFrame` object for a given page id. When
     /// the page is not loaded into memory, it is read from disk. Otherwise the
     /// loaded page is used.
-    /// When the page cannot be loaded because the buffer is full, throws the
-    /// exception `buffer_full_error`.
+    /// When the page cannot be loaded because the buffer (or, with several
+    /// partitions, the page's partition) is full, throws the exception
+    /// `buffer_full_error`.
     /// Is thread-safe w.r.t. other concurrent calls to `fix_page()` and
     /// `unfix_page()`.
     /// @param[in] page_id   Page id of the page that should be loaded.
@@ -106,18 +571,126 @@ public:
     ///                      non-exclusively (shared).
     BufferFrame& fix_page(uint64_t page_id, bool exclusive);
 
+    /// Like `fix_page()`, but a page that is not resident is loaded into the
+    /// ring of `strategy` instead of the main pool. See `ScanStrategy`.
+    BufferFrame& fix_page(uint64_t page_id, bool exclusive, ScanStrategy& strategy);
+
     /// Takes a `BufferFrame` reference that was returned by an earlier call to
     /// `fix_page()` and unfixes it. When `is_dirty` is / true, the page is
-    /// written back to disk eventually.
+    /// written back to disk eventually. A page stays dirty until it has been
+    /// written back, even when later fixes unfix it with `is_dirty` false.
     void unfix_page(BufferFrame& page, bool is_dirty);
 
+    /// Turns a shared fix of `page` into an exclusive one, unless other
+    /// fixes hold the page shared. Returns whether it did. Never waits, so
+    /// it cannot deadlock with another fix trying to upgrade the same page.
+    /// On failure the page stays fixed shared.
+    bool try_upgrade_page(BufferFrame& page);
+
+    /// Turns a shared fix of `page` into an exclusive one. The page stays
+    /// fixed throughout, so it cannot be evicted, but when other fixes hold
+    /// it shared, the shared latch is given up while waiting for the
+    /// exclusive one. Returns whether the upgrade was atomic; if not,
+    /// another fix may have modified the page in between, and whatever was
+    /// read under the shared fix has to be checked again.
+    bool upgrade_page(BufferFrame& page);
+
+    /// Turns an exclusive fix of `page` into a shared one, without letting
+    /// another exclusive fix in between. Whether the page was modified is
+    /// still only reported to `unfix_page()`.
+    void downgrade_page(BufferFrame& page);
+
+    /// Starts an optimistic read of `page_id`. Takes no latch, does not fix
+    /// the page and writes no shared memory, so concurrent readers do not
+    /// contend at all. Returns the frame that currently holds the page and
+    /// stores its version in `version`, or returns nullptr when the page is
+    /// not resident or is latched exclusively; callers then fall back to
+    /// `fix_page()`. The page may change or be evicted at any time, so
+    /// whatever is read from the frame is only valid if `validate_page()`
+    /// succeeds afterwards. Optimistic reads are not reported to the
+    /// replacement policy.
+    /// Is thread-safe.
+    BufferFrame* fix_page_optimistic(uint64_t page_id, uint64_t& version) {
+        BufferFrame* frame = getPartition(page_id).pageTable.find(page_id);
+        if (frame == nullptr) {
+            return nullptr;
+        }
+        // A frame that is being given another page is latched exclusively,
+        // so the id is only checked once the latch is known to be free.
+        if (!frame->latch.try_lock_optimistic(version) || frame->pageId != page_id ||
+                frame->isLoading()) {
+            return nullptr;
+        }
+        return frame;
+    }
+
+    /// Returns whether `frame` was neither latched exclusively nor given
+    /// another page since `fix_page_optimistic()` returned `version`, so
+    /// that everything read from it in between is consistent.
+    /// Is thread-safe.
+    static bool validate_page(const BufferFrame& frame, uint64_t version) {
+        return frame.latch.validate(version);
+    }
+
+    /// Calls `fn(data)` with the data of `page_id` and returns its result.
+    /// Tries optimistic reads up to `attempts` times and then fixes the page
+    /// shared. `fn` may run more than once and may see a torn page in all
+    /// but the last run, so it must not trust offsets or pointers it reads
+    /// without bounds checks, and must not have side effects.
+    template <typename Fn>
+    auto read_page(uint64_t page_id, Fn&& fn, size_t attempts = 4) {
+        for (size_t i = 0; i < attempts; i++) {
+            uint64_t version;
+            BufferFrame* frame = fix_page_optimistic(page_id, version);
+            if (frame == nullptr) {
+                break;
+            }
+            auto result = fn(static_cast<const char*>(frame->get_data()));
+            if (validate_page(*frame, version)) {
+                return result;
+            }
+        }
+        BufferFrame& page = fix_page(page_id, false);
+        try {
+            auto result = fn(static_cast<const char*>(page.get_data()));
+            unfix_page(page, false);
+            return result;
+        } catch (...) {
+            unfix_page(page, false);
+            throw;
+        }
+    }
+
+    /// Writes all dirty pages to disk and makes the writes durable, including
+    /// those of earlier evictions. Pages that are fixed exclusively are
+    /// written once they are unfixed, so the calling thread must not hold
+    /// exclusive fixes itself.
+    /// Is thread-safe.
+    void flush_all();
+
+    /// Returns a snapshot of the manager's counters.
+    /// Is thread-safe.
+    BufferManagerStats get_stats() const;
+
+    /// Returns the number of frames that hold pages of `segment_id`,
+    /// including pages that are still being loaded.
+    /// Is thread-safe and does not take any latch.
+    size_t get_segment_residency(uint16_t segment_id) const {
+        return segmentResidency[segment_id].load(std::memory_order_relaxed);
+    }
+
     /// Returns the page ids of all pages (fixed and unfixed) that are in the
-    /// FIFO list in FIFO order.
+    /// FIFO list in FIFO order. With several partitions, the lists of all
+    /// partitions are concatenated in partition order. ARC reports T1 here,
+    /// LRU-K the pages with fewer than K accesses in eviction order, and
+    /// CLOCK reports all resident pages in the order the hand visits them.
     /// Is not thread-safe.
     std::vector<uint64_t> get_fifo_list() const;
 
     /// Returns the page ids of all pages (fixed and unfixed) that are in the
-    /// LRU list in LRU order.
+    /// LRU list in LRU order. With several partitions, the lists of all
+    /// partitions are concatenated in partition order. ARC reports T2 here,
+    /// LRU-K the remaining pages in eviction order. Empty with CLOCK.
     /// Is not thread-safe.
     std::vector<uint64_t> get_lru_list() const;
 
@@ -0,0 +1,47 @@
+#ifndef CLOCK_POLICY_H_GUARD
+#define CLOCK_POLICY_H_GUARD
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "buffer/replacement_policy.h"
+
+namespace buzzdb {
+
+/// Second-chance clock. A hit only sets the frame's reference bit, so the
+/// hit path writes no shared list and needs no queue latch. To find a victim
+/// the hand sweeps the frames, clearing set reference bits, and stops at the
+/// first page whose bit is already clear.
+class ClockPolicy : public ReplacementPolicy {
+private:
+    BufferFrame* frames;
+    size_t frameCount;
+    /// Reference bit of frame `frames + i`.
+    std::unique_ptr<std::atomic<bool>[]> referenced;
+    /// Whether frame `frames + i` holds a page.
+    std::vector<bool> resident;
+    /// Index of the next frame the hand looks at.
+    size_t hand;
+
+public:
+    ClockPolicy(BufferFrame* frames, size_t frame_count);
+
+    bool is_access_latch_free() const override {
+        return true;
+    }
+
+    void on_admit(BufferFrame& frame) override;
+
+    void on_hit(BufferFrame& frame) override;
+
+    BufferFrame* pick_victim(uint64_t incoming_page_id, const VictimFilter& filter) override;
+
+    void on_evict(BufferFrame& frame) override;
+
+    /// Returns all resident frames in the order the hand will visit them.
+    std::vector<BufferFrame*> get_fifo_list() const override;
+};
+
+}  // namespace buzzdb
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef FREQUENCY_SKETCH_H_GUARD
+#define FREQUENCY_SKETCH_H_GUARD
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace buzzdb {
+
+/// Estimates how often page ids were accessed recently (TinyLFU, Einziger,
+/// Friedman and Manes, 2017).
+///
+/// A count-min sketch with four rows of 4-bit counters, sixteen to a word.
+/// An estimate is the smallest of a page's four counters, so it can be too
+/// high because of collisions but never too low. Counters saturate at 15.
+/// After ten times as many increments as the sketch was sized for, all
+/// counters are halved, so that the estimates follow a changing workload.
+///
+/// Takes 2 bytes per expected entry. Is thread-safe; concurrent increments
+/// of the same word retry, and increments racing with the halving may be
+/// lost, which only makes estimates slightly low.
+class FrequencySketch {
+private:
+    static constexpr size_t DEPTH = 4;
+    static constexpr uint64_t MAX_COUNT = 15;
+
+    /// `DEPTH` rows of `width` counters each, packed into words.
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+    size_t wordCount;
+    /// Counters per row minus one; the width is a power of two.
+    size_t mask;
+    size_t sampleSize;
+    std::atomic<size_t> additions;
+
+    /// Returns the index of the counter of `hash` in `row`, counted over the
+    /// whole sketch.
+    size_t counterIndex(uint64_t hash, size_t row) const;
+
+    void halve();
+
+public:
+    /// Constructor.
+    /// @param[in] expected_entries Number of distinct pages whose frequency
+    ///                             should be told apart, e.g. the number of
+    ///                             frames.
+    explicit FrequencySketch(size_t expected_entries);
+
+    /// Records an access to `page_id`.
+    void increment(uint64_t page_id);
+
+    /// Returns the estimated number of recent accesses to `page_id`.
+    uint32_t estimate(uint64_t page_id) const;
+};
+
+}  // namespace buzzdb
+
+#endif
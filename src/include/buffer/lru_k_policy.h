@@ -0,0 +1,111 @@
+#ifndef LRU_K_POLICY_H_GUARD
+#define LRU_K_POLICY_H_GUARD
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "buffer/replacement_policy.h"
+
+namespace buzzdb {
+
+/// LRU-K (O'Neil, O'Neil and Weikum, SIGMOD 1993).
+///
+/// Evicts the page whose K-th most recent access lies furthest back. Pages
+/// with fewer than K accesses count as infinitely old and go first, oldest
+/// first access first, so pages that are touched once do not displace pages
+/// that are referenced at a steady rate. Time is a logical clock that ticks
+/// with every access to the partition.
+///
+/// Accesses within the correlated reference period after the previous one
+/// are treated as part of the same reference: they only refresh the time of
+/// the last access, and pages are not evicted during that period unless
+/// nothing else can be. With K = 1 and no correlated period this is exact
+/// LRU.
+///
+/// The history of evicted pages is retained for as many pages as there are
+/// frames, so that a page that is evicted and soon read again keeps its
+/// earlier accesses. Without that, newly hot pages would never collect K
+/// accesses while older hot pages hold on to theirs.
+///
+/// Frames are ordered in an indexed binary min-heap, so hits and victim
+/// selection cost O(log n) plus O(log n) per frame that has to be skipped.
+class LruKPolicy : public ReplacementPolicy {
+private:
+    static constexpr uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+    BufferFrame* frames;
+    size_t k;
+    uint64_t correlatedPeriod;
+    uint64_t clock;
+    /// `history[i * k + j]` is the (j + 1)-th most recent uncorrelated access
+    /// to frame `frames + i`, or 0 if there was none.
+    std::vector<uint64_t> history;
+    /// Most recent access to frame `frames + i`, correlated or not.
+    std::vector<uint64_t> lastAccess;
+    /// Resident frames as a min-heap ordered by `less()`.
+    std::vector<uint32_t> heap;
+    /// Position of frame `frames + i` in `heap`.
+    std::vector<uint32_t> heapPosition;
+    /// Ring of evicted pages whose history is retained. Slot `i` holds page
+    /// `retainedPageIds[i]` with history `retainedHistory[i * k ...]`.
+    std::vector<uint64_t> retainedPageIds;
+    std::vector<uint64_t> retainedHistory;
+    size_t nextRetained;
+    /// Maps a retained page id to its slot.
+    std::unordered_map<uint64_t, uint32_t> retained;
+
+    uint64_t kthAccess(uint32_t frame) const {
+        return history[frame * k + k - 1];
+    }
+
+    /// Returns the oldest access in the history of `frame`.
+    uint64_t oldestAccess(uint32_t frame) const {
+        size_t i = k - 1;
+        while (i > 0 && history[frame * k + i] == 0) {
+            i--;
+        }
+        return history[frame * k + i];
+    }
+
+    /// Returns whether `a` should be evicted before `b`.
+    bool less(uint32_t a, uint32_t b) const {
+        if (kthAccess(a) != kthAccess(b)) {
+            return kthAccess(a) < kthAccess(b);
+        }
+        return oldestAccess(a) < oldestAccess(b);
+    }
+
+    void place(size_t position, uint32_t frame);
+    void siftUp(size_t position);
+    void siftDown(size_t position);
+
+    /// Records an access at the current time in the history of `index`.
+    void recordAccess(uint32_t index, uint64_t now);
+
+    std::vector<BufferFrame*> sortedFrames(bool complete_history) const;
+
+public:
+    /// Constructor.
+    /// @param[in] k                 Number of accesses that are remembered.
+    /// @param[in] correlated_period Number of partition accesses after an
+    ///                              access that count as correlated with it.
+    LruKPolicy(BufferFrame* frames, size_t frame_count, size_t k, uint64_t correlated_period);
+
+    void on_admit(BufferFrame& frame) override;
+
+    void on_hit(BufferFrame& frame) override;
+
+    BufferFrame* pick_victim(uint64_t incoming_page_id, const VictimFilter& filter) override;
+
+    void on_evict(BufferFrame& frame) override;
+
+    /// Returns the frames with fewer than K accesses, in eviction order.
+    std::vector<BufferFrame*> get_fifo_list() const override;
+
+    /// Returns the frames with K accesses or more, in eviction order.
+    std::vector<BufferFrame*> get_lru_list() const override;
+};
+
+}  // namespace buzzdb
+
+#endif
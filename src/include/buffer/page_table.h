@@ -0,0 +1,96 @@
+#ifndef PAGE_TABLE_H_GUARD
+#define PAGE_TABLE_H_GUARD
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/macros.h"
+
+namespace buzzdb {
+
+class BufferFrame;
+
+/// Maps page ids to the buffer frames that currently hold them.
+///
+/// Open addressing with linear probing over a flat slot array, so a lookup
+/// usually touches a single cache line. Deletion shifts the following
+/// entries of the probe sequence back instead of leaving tombstones, which
+/// keeps probe lengths short no matter how many pages have been evicted.
+/// The capacity is fixed at construction: a buffer manager never holds more
+/// than `page_count` pages, so the table never has to grow.
+///
+/// Lookups may run concurrently with each other. Mutations must be
+/// serialized by the caller. A lookup that races with a mutation is
+/// memory-safe but may miss an entry that is being moved or return a frame
+/// that is being reassigned, so callers doing that must validate the result.
+class PageTable {
+private:
+    struct Slot {
+        std::atomic<uint64_t> pageId{INVALID_PAGE_ID};
+        std::atomic<BufferFrame*> frame{nullptr};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    size_t count;
+
+public:
+    /// Hash function for page ids. The table indexes with the low bits.
+    static uint64_t hash(uint64_t page_id) {
+        // MurmurHash3 finalizer. Page ids are mostly dense within a segment,
+        // so they need to be scrambled before taking the low bits.
+        page_id ^= page_id >> 33;
+        page_id *= 0xff51afd7ed558ccdull;
+        page_id ^= page_id >> 33;
+        page_id *= 0xc4ceb9fe1a85ec53ull;
+        page_id ^= page_id >> 33;
+        return page_id;
+    }
+
+    /// Constructor.
+    /// @param[in] max_entries Maximum number of pages that will be stored in
+    ///                        the table at the same time.
+    explicit PageTable(size_t max_entries);
+
+    /// Returns the frame that holds `page_id` or nullptr if the page is not in
+    /// the table.
+    BufferFrame* find(uint64_t page_id) const {
+        for (size_t i = hash(page_id) & mask;; i = (i + 1) & mask) {
+            uint64_t key = slots[i].pageId.load(std::memory_order_acquire);
+            if (key == page_id) {
+                return slots[i].frame.load(std::memory_order_relaxed);
+            }
+            if (key == INVALID_PAGE_ID) {
+                return nullptr;
+            }
+        }
+    }
+
+    /// Inserts a mapping. `page_id` must not be in the table yet.
+    void insert(uint64_t page_id, BufferFrame* frame);
+
+    /// Removes the mapping for `page_id`. Returns false if there was none.
+    bool erase(uint64_t page_id);
+
+    /// Returns the number of pages in the table.
+    size_t size() const {
+        return count;
+    }
+
+    /// Calls `fn(page_id, frame)` for every mapping in the table.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i <= mask; i++) {
+            uint64_t key = slots[i].pageId.load(std::memory_order_relaxed);
+            if (key != INVALID_PAGE_ID) {
+                fn(key, slots[i].frame.load(std::memory_order_relaxed));
+            }
+        }
+    }
+};
+
+}  // namespace buzzdb
+
+#endif
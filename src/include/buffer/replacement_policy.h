@@ -0,0 +1,96 @@
+#ifndef REPLACEMENT_POLICY_H_GUARD
+#define REPLACEMENT_POLICY_H_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace buzzdb {
+
+class BufferFrame;
+struct BufferManagerOptions;
+
+/// Replacement policies a `BufferManager` can be configured with.
+enum class ReplacementPolicyType {
+    /// FIFO queue for pages accessed once, LRU queue for the others.
+    TWO_QUEUE,
+    /// Second-chance clock over all frames.
+    CLOCK,
+    /// Adaptive Replacement Cache with ghost lists of evicted pages.
+    ARC,
+    /// Evicts the page whose K-th most recent access is the oldest.
+    LRU_K,
+    /// Evicts the least recently used of a few randomly sampled pages.
+    SAMPLED_LRU,
+};
+
+/// Decides which page a buffer manager partition evicts next.
+///
+/// Every partition owns one policy instance that covers the partition's
+/// frames, which form a contiguous slice of the frame array, so a policy can
+/// keep its per-frame state in arrays indexed by `frame - frames`.
+///
+/// The buffer manager calls all hooks with the partition's queue latch held.
+/// `on_admit()`, `pick_victim()` and `on_evict()` are additionally called
+/// with the partition latch held exclusively. When `is_access_latch_free()`
+/// returns true, `on_hit()` and `on_unfix()` are called without any latch,
+/// so they must be thread-safe among themselves and may run concurrently
+/// with the other hooks. They are only called for fixed frames, which are
+/// never evicted, and `pick_victim()` must tolerate their concurrent updates.
+class ReplacementPolicy {
+public:
+    /// Returns whether a frame may be evicted right now.
+    using VictimFilter = std::function<bool(BufferFrame&)>;
+
+    virtual ~ReplacementPolicy() = default;
+
+    /// Creates the policy selected in `options` for `frame_count` frames
+    /// starting at `frames`.
+    static std::unique_ptr<ReplacementPolicy> create(const BufferManagerOptions& options,
+                                                     BufferFrame* frames,
+                                                     size_t frame_count);
+
+    /// Returns whether `on_hit()` and `on_unfix()` can run without the queue
+    /// latch.
+    virtual bool is_access_latch_free() const {
+        return false;
+    }
+
+    /// A page was loaded into `frame`, which was free or just evicted.
+    virtual void on_admit(BufferFrame& frame) = 0;
+
+    /// The resident page in `frame` was fixed again.
+    virtual void on_hit(BufferFrame& frame) = 0;
+
+    /// The page in `frame` was unfixed.
+    virtual void on_unfix(BufferFrame&) {}
+
+    /// Returns the frame whose page should be evicted to make room for
+    /// `incoming_page_id`, or nullptr when `filter` rejects every candidate.
+    /// `filter` is called in eviction order and only for frames that are
+    /// returned if it accepts them, since it may count or record what it
+    /// rejects. The frame stays tracked until `on_evict()` is called for it.
+    virtual BufferFrame* pick_victim(uint64_t incoming_page_id,
+                                     const VictimFilter& filter) = 0;
+
+    /// The page in `frame` is evicted. The frame is either admitted again
+    /// right away or returned to the free list.
+    virtual void on_evict(BufferFrame& frame) = 0;
+
+    /// Returns the tracked frames of pages that were accessed once, in
+    /// eviction order. Policies that do not tell first accesses apart return
+    /// all tracked frames here.
+    virtual std::vector<BufferFrame*> get_fifo_list() const = 0;
+
+    /// Returns the tracked frames of pages that were accessed more than once,
+    /// in eviction order.
+    virtual std::vector<BufferFrame*> get_lru_list() const {
+        return {};
+    }
+};
+
+}  // namespace buzzdb
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SAMPLED_LRU_POLICY_H_GUARD
+#define SAMPLED_LRU_POLICY_H_GUARD
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "buffer/replacement_policy.h"
+
+namespace buzzdb {
+
+/// Approximated LRU in the style of Redis. Every frame carries a coarse
+/// timestamp of its last access. To find a victim, `sample_size` resident
+/// frames are drawn at random and the least recently used of them goes.
+///
+/// Time is a logical clock that ticks with every admission, so a hit only
+/// copies the current time into its own frame's timestamp and writes no
+/// shared state. Hits therefore need no queue latch. All hits between two
+/// misses get the same timestamp; the policy cannot tell them apart, which
+/// costs little since pages are only compared when a miss needs a victim.
+class SampledLruPolicy : public ReplacementPolicy {
+private:
+    static constexpr uint32_t NOT_RESIDENT = UINT32_MAX;
+
+    BufferFrame* frames;
+    size_t sampleSize;
+    std::atomic<uint64_t> clock;
+    /// Time of the last access to frame `frames + i`.
+    std::unique_ptr<std::atomic<uint64_t>[]> lastAccess;
+    /// Indexes of the resident frames in no particular order, for sampling.
+    std::vector<uint32_t> resident;
+    /// Position of frame `frames + i` in `resident`.
+    std::vector<uint32_t> residentPosition;
+    /// State of the xorshift generator that draws the samples.
+    uint64_t random;
+
+    uint64_t nextRandom();
+
+public:
+    SampledLruPolicy(BufferFrame* frames, size_t frame_count, size_t sample_size);
+
+    bool is_access_latch_free() const override {
+        return true;
+    }
+
+    void on_admit(BufferFrame& frame) override;
+
+    void on_hit(BufferFrame& frame) override;
+
+    /// Evicts the least recently used of `sample_size` random frames that
+    /// pass `filter`. Draws up to a few samples before falling back to the
+    /// least recently used of all frames that pass. `filter` sees each
+    /// frame at most once, and each sample least recently used first.
+    BufferFrame* pick_victim(uint64_t incoming_page_id, const VictimFilter& filter) override;
+
+    void on_evict(BufferFrame& frame) override;
+
+    /// Returns all resident frames, least recently used first.
+    std::vector<BufferFrame*> get_fifo_list() const override;
+};
+
+}  // namespace buzzdb
+
+#endif
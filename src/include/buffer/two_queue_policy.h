@@ -0,0 +1,58 @@
+#ifndef TWO_QUEUE_POLICY_H_GUARD
+#define TWO_QUEUE_POLICY_H_GUARD
+
+#include <memory>
+#include "buffer/replacement_policy.h"
+#include "common/intrusive_list.h"
+
+namespace buzzdb {
+
+/// Simplified 2Q. Pages enter a FIFO queue on their first access and move to
+/// an LRU queue on their second. Victims come from the FIFO queue first, so
+/// pages that are touched only once (scans) do not push out the working set.
+/// Every hit on an LRU page relinks it, so hits need the queue latch.
+class TwoQueuePolicy : public ReplacementPolicy {
+private:
+    /// Queue the frame is linked into.
+    enum class Queue : uint8_t { NONE, FIFO, LRU };
+
+    struct Node {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        Queue queue = Queue::NONE;
+        BufferFrame* frame = nullptr;
+    };
+
+    BufferFrame* frames;
+    /// Node `i` belongs to frame `frames + i`.
+    std::unique_ptr<Node[]> nodes;
+    /// Pages accessed once, oldest first.
+    IntrusiveList<Node> fifoQueue;
+    /// Pages accessed more than once, least recently used first.
+    IntrusiveList<Node> lruQueue;
+
+    Node& getNode(BufferFrame& frame);
+
+    static std::vector<BufferFrame*> toFrames(const IntrusiveList<Node>& queue);
+
+public:
+    TwoQueuePolicy(BufferFrame* frames, size_t frame_count);
+
+    void on_admit(BufferFrame& frame) override;
+
+    void on_hit(BufferFrame& frame) override;
+
+    void on_unfix(BufferFrame& frame) override;
+
+    BufferFrame* pick_victim(uint64_t incoming_page_id, const VictimFilter& filter) override;
+
+    void on_evict(BufferFrame& frame) override;
+
+    std::vector<BufferFrame*> get_fifo_list() const override;
+
+    std::vector<BufferFrame*> get_lru_list() const override;
+};
+
+}  // namespace buzzdb
+
+#endif
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace buzzdb {
+
+/// Reader-writer latch in a single 64-bit word that can also be read
+/// optimistically.
+///
+/// The low half of the word counts shared holders and has a flag for
+/// parked waiters; the high half is a version that is odd while the latch
+/// is held exclusively and advances with every exclusive acquire and
+/// release. Optimistic readers take no latch: they remember an even version
+/// and afterwards check that it did not change, which tells them that no
+/// exclusive holder was active in between.
+///
+/// Acquiring spins for a bounded number of rounds and then parks the thread
+/// on a futex over the low half of the word, so that short critical
+/// sections never enter the kernel and long ones do not burn CPU. Releases
+/// only make a system call when somebody is parked. Shared holders are
+/// preferred over waiting exclusive ones, like the default
+/// `std::shared_mutex` on Linux.
+///
+/// Meets the `Lockable` and `SharedLockable` requirements.
+/// Is thread-safe.
+class HybridLatch {
+ private:
+  /// Number of shared holders.
+  static constexpr uint64_t SHARED_MASK = (uint64_t{1} << 30) - 1;
+  /// At least one thread is parked on the futex.
+  static constexpr uint64_t PARKED = uint64_t{1} << 30;
+  /// Lowest bit of the version, set while the latch is held exclusively.
+  static constexpr uint64_t EXCLUSIVE = uint64_t{1} << 32;
+  static constexpr int VERSION_SHIFT = 32;
+
+  std::atomic<uint64_t> word{0};
+
+  /// Spins and then parks until the latch is acquired in the given mode.
+  void wait(bool exclusive);
+
+  /// Wakes all parked threads.
+  void wake();
+
+ public:
+  HybridLatch() = default;
+  HybridLatch(const HybridLatch&) = delete;
+  HybridLatch& operator=(const HybridLatch&) = delete;
+
+  /// Acquires the latch exclusively if nobody holds it.
+  bool try_lock() {
+    uint64_t current = word.load(std::memory_order_relaxed);
+    while ((current & (EXCLUSIVE | SHARED_MASK)) == 0) {
+      if (word.compare_exchange_weak(current, current + EXCLUSIVE,
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed)) {
+        // Optimistic readers that see anything written from now on must
+        // also see the odd version.
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Acquires the latch exclusively.
+  void lock() {
+    if (!try_lock()) {
+      wait(true);
+    }
+  }
+
+  /// Releases the exclusive latch and advances the version.
+  void unlock() {
+    uint64_t current = word.load(std::memory_order_relaxed);
+    while (!word.compare_exchange_weak(current, (current + EXCLUSIVE) & ~PARKED,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+    if ((current & PARKED) != 0) {
+      wake();
+    }
+  }
+
+  /// Acquires the latch shared unless it is held exclusively.
+  bool try_lock_shared() {
+    uint64_t current = word.load(std::memory_order_relaxed);
+    while ((current & EXCLUSIVE) == 0) {
+      if (word.compare_exchange_weak(current, current + 1,
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Acquires the latch shared.
+  void lock_shared() {
+    if (!try_lock_shared()) {
+      wait(false);
+    }
+  }
+
+  /// Releases a shared latch.
+  void unlock_shared() {
+    uint64_t current = word.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+      next = current - 1;
+      // Only exclusive waiters park while the latch is held shared, and
+      // they can only proceed once the last shared holder is gone.
+      if ((next & SHARED_MASK) == 0) {
+        next &= ~PARKED;
+      }
+    } while (!word.compare_exchange_weak(current, next,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+    if ((current & PARKED) != 0 && (next & PARKED) == 0) {
+      wake();
+    }
+  }
+
+  /// Turns the caller's shared latch into an exclusive one if nobody else
+  /// holds it shared. Never waits, so two holders trying to upgrade at the
+  /// same time cannot deadlock.
+  bool try_upgrade() {
+    uint64_t current = word.load(std::memory_order_relaxed);
+    while ((current & SHARED_MASK) == 1) {
+      if (word.compare_exchange_weak(current, current - 1 + EXCLUSIVE,
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed)) {
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Turns the caller's shared latch into an exclusive one. When other
+  /// shared holders keep `try_upgrade()` from succeeding, releases the
+  /// shared latch and waits for the exclusive one. Returns whether the
+  /// upgrade was atomic; if it was not, another thread may have held the
+  /// latch exclusively in between, and what was read under the shared
+  /// latch may be stale.
+  bool upgrade() {
+    if (try_upgrade()) {
+      return true;
+    }
+    uint64_t version = word.load(std::memory_order_relaxed) >> VERSION_SHIFT;
+    unlock_shared();
+    lock();
+    return (word.load(std::memory_order_relaxed) >> VERSION_SHIFT) == version + 1;
+  }
+
+  /// Turns the caller's exclusive latch into a shared one without letting
+  /// another exclusive holder in between. Advances the version like
+  /// `unlock()`.
+  void downgrade() {
+    uint64_t current = word.load(std::memory_order_relaxed);
+    while (!word.compare_exchange_weak(current,
+                                       ((current + EXCLUSIVE) & ~PARKED) + 1,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+    // Parked shared waiters can proceed now; exclusive ones park again.
+    if ((current & PARKED) != 0) {
+      wake();
+    }
+  }
+
+  /// Returns whether the latch is held exclusively.
+  bool is_locked_exclusively() const {
+    return (word.load(std::memory_order_relaxed) & EXCLUSIVE) != 0;
+  }
+
+  /// Starts an optimistic read. Returns false if the latch is held
+  /// exclusively; otherwise stores the current version in `version`.
+  bool try_lock_optimistic(uint64_t& version) const {
+    version = word.load(std::memory_order_acquire) >> VERSION_SHIFT;
+    return (version & 1) == 0;
+  }
+
+  /// Returns whether the latch was not acquired exclusively since
+  /// `try_lock_optimistic()` returned `version`, so that everything read
+  /// under the optimistic latch in between is consistent. The version wraps
+  /// after 2^32 exclusive acquires, which a reader is assumed not to
+  /// outlast.
+  bool validate(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (word.load(std::memory_order_relaxed) >> VERSION_SHIFT) == version;
+  }
+};
+
+}  // namespace buzzdb
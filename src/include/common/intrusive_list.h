@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+
+namespace buzzdb {
+
+/// Doubly-linked list over nodes that embed their own links.
+/// `T` must have `T* prev` and `T* next` members that are not used by anything
+/// else while the node is linked. A node can be in at most one list at a time.
+/// Insertion and removal are O(1) and never allocate.
+/// Is not thread-safe.
+template <typename T>
+class IntrusiveList {
+ private:
+  T* head = nullptr;
+  T* tail = nullptr;
+  size_t count = 0;
+
+ public:
+  IntrusiveList() = default;
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+  bool empty() const { return count == 0; }
+
+  size_t size() const { return count; }
+
+  /// Returns the first node or nullptr if the list is empty.
+  T* front() const { return head; }
+
+  /// Returns the last node or nullptr if the list is empty.
+  T* back() const { return tail; }
+
+  /// Returns the node after `node` or nullptr if `node` is the last one.
+  static T* next(const T* node) { return node->next; }
+
+  /// Returns the node before `node` or nullptr if `node` is the first one.
+  static T* prev(const T* node) { return node->prev; }
+
+  /// Appends `node`, which must not be linked.
+  void push_back(T* node) {
+    node->prev = tail;
+    node->next = nullptr;
+    if (tail != nullptr) {
+      tail->next = node;
+    } else {
+      head = node;
+    }
+    tail = node;
+    count++;
+  }
+
+  /// Prepends `node`, which must not be linked.
+  void push_front(T* node) {
+    node->prev = nullptr;
+    node->next = head;
+    if (head != nullptr) {
+      head->prev = node;
+    } else {
+      tail = node;
+    }
+    head = node;
+    count++;
+  }
+
+  /// Unlinks `node`, which must be in this list.
+  void remove(T* node) {
+    if (node->prev != nullptr) {
+      node->prev->next = node->next;
+    } else {
+      head = node->next;
+    }
+    if (node->next != nullptr) {
+      node->next->prev = node->prev;
+    } else {
+      tail = node->prev;
+    }
+    node->prev = nullptr;
+    node->next = nullptr;
+    count--;
+  }
+
+  /// Unlinks and returns the first node or nullptr if the list is empty.
+  T* pop_front() {
+    T* node = head;
+    if (node != nullptr) {
+      remove(node);
+    }
+    return node;
+  }
+
+  /// Moves `node`, which must be in this list, to the end.
+  void move_to_back(T* node) {
+    if (node == tail) {
+      return;
+    }
+    remove(node);
+    push_back(node);
+  }
+};
+
+}  // namespace buzzdb
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 
 namespace buzzdb {
@@ -13,6 +15,25 @@ class File {
   /// File mode (read or write)
   enum Mode { READ, WRITE };
 
+  /// Buffers, offsets and sizes of I/O on files opened with
+  /// `OpenOptions::direct_io` must be multiples of this. It covers the
+  /// logical block size of all common devices.
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /// Options for opening a file.
+  struct OpenOptions {
+    /// Bypass the kernel page cache (O_DIRECT), so that data is not cached
+    /// twice when the caller keeps its own cache. See `DIRECT_IO_ALIGNMENT`.
+    bool direct_io = false;
+    /// Open with O_SYNC, so that every write is durable when it returns.
+    /// Without it, writes are only durable after `sync()`.
+    bool sync_writes = true;
+  };
+
+  /// Completion handler of an asynchronous request. `error` is 0 when the
+  /// request succeeded and an `errno` value otherwise.
+  using Callback = std::function<void(int error)>;
+
   virtual ~File() = default;
 
   /// Returns the `Mode` this file was opened with.
@@ -29,7 +50,8 @@ class File {
   virtual void resize(size_t new_size) = 0;
 
   /// Reads a block of the file. `offset + size` must not be larger than
-  /// `size()`.
+  /// `size()`. Implementations that tolerate reads past the end of the file
+  /// fill the missing part of `block` with zeros.
   /// Is thread-safe w.r.t concurrent calls to `read_block()` and
   /// `write_block()`.
   /// @param[in]  offset The offset in the file from which the block should
@@ -59,11 +81,59 @@ class File {
   /// @param[in] size   The size of the block.
   virtual void write_block(const char* block, size_t offset, size_t size) = 0;
 
+  /// Waits until all completed writes are durable (fdatasync). Files that
+  /// are not backed by storage do nothing.
+  virtual void sync() {}
+
+  /// Submits a read of a block without waiting for it. `block` must stay
+  /// valid until `callback` has run. The callback runs in whichever thread
+  /// reaps the completion, i.e. inside a later call to `poll()` or to
+  /// another `*_async()` function of this file.
+  /// The default implementation reads synchronously and runs `callback`
+  /// before returning.
+  /// Is thread-safe.
+  virtual void read_block_async(size_t offset, size_t size, char* block,
+                                Callback callback);
+
+  /// Submits a write of a block without waiting for it. Same rules as for
+  /// `read_block_async()` and `write_block()` apply.
+  /// Is thread-safe.
+  virtual void write_block_async(const char* block, size_t offset, size_t size,
+                                 Callback callback);
+
+  /// Reaps completed asynchronous requests and runs their callbacks. Blocks
+  /// until at least `min_completions` requests completed (or none are in
+  /// flight anymore). Returns the number of completed requests.
+  /// Is thread-safe.
+  virtual size_t poll(size_t min_completions = 0) {
+    (void)min_completions;
+    return 0;
+  }
+
+  /// Returns the number of submitted requests that have not been reaped yet.
+  virtual size_t in_flight() const { return 0; }
+
   /// Opens a file with the given mode. Existing files are never overwritten.
   /// @param[in] filename Path to the file.
   /// @param[in] mode     `Mode` that should be used to open the file.
   static std::unique_ptr<File> open_file(const char* filename, Mode mode);
 
+  /// Opens a file with the given mode and options. Existing files are never
+  /// overwritten.
+  static std::unique_ptr<File> open_file(const char* filename, Mode mode,
+                                         const OpenOptions& options);
+
+  /// Opens a file like `open_file()` whose asynchronous requests are served
+  /// by io_uring with up to `queue_depth` requests in flight. Falls back to
+  /// `open_file()` when the kernel does not allow io_uring.
+  static std::unique_ptr<File> open_async_file(const char* filename, Mode mode,
+                                               unsigned queue_depth = 64);
+
+  /// Same as above with `OpenOptions`.
+  static std::unique_ptr<File> open_async_file(const char* filename, Mode mode,
+                                               const OpenOptions& options,
+                                               unsigned queue_depth = 64);
+
   /// Opens a temporary file in `WRITE` mode. The file will be deleted
   /// automatically after use.
   static std::unique_ptr<File> make_temporary_file();
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "storage/file.h"
+
+namespace buzzdb {
+
+///
+/// Keeps the files of recently used segments open.
+///
+/// Files are opened lazily on first use and shared by all callers. When more
+/// than `max_open_files` segments are open, the least recently used one is
+/// dropped from the cache. It is closed as soon as the last caller that
+/// still holds it lets go.
+/// Is thread-safe.
+///
+class FileCache {
+ public:
+  /// Opens the file of a segment.
+  using Opener = std::function<std::unique_ptr<File>(uint16_t segment_id)>;
+
+  /// Constructor.
+  /// @param[in] max_open_files Number of segments kept open at most.
+  /// @param[in] opener         Called to open a segment that is not cached.
+  FileCache(size_t max_open_files, Opener opener);
+
+  /// Returns the file of `segment_id`, opening it if necessary. The opener
+  /// runs without the cache latch, so concurrent misses on one segment may
+  /// both open it; all callers get the file that was cached first.
+  std::shared_ptr<File> get(uint16_t segment_id);
+
+  /// Returns the number of segments that are currently cached.
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<File> file;
+    /// Position of the segment in `lru`.
+    std::list<uint16_t>::iterator lru_position;
+  };
+
+  size_t max_open_files;
+  Opener opener;
+  mutable std::mutex mutex;
+  std::unordered_map<uint16_t, Entry> files;
+  /// Cached segments, least recently used first.
+  std::list<uint16_t> lru;
+};
+
+}  // namespace buzzdb
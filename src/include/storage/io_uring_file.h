@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "storage/posix_file.h"
+
+namespace buzzdb {
+
+///
+/// `PosixFile` whose asynchronous requests go through an io_uring instance.
+/// Synchronous `read_block()` and `write_block()` still use `pread` and
+/// `pwrite`.
+///
+class IoUringFile : public PosixFile {
+ public:
+  /// Returns whether this process may create io_uring instances. Kernels
+  /// before 5.1 and sandboxes that filter the syscalls do not allow it.
+  static bool is_supported();
+
+  /// Opens `filename` like `PosixFile` and sets up a ring with room for
+  /// `queue_depth` requests in flight.
+  IoUringFile(const char* filename, Mode mode, const OpenOptions& options,
+              unsigned queue_depth);
+
+  ~IoUringFile() override;
+
+  void read_block_async(size_t offset, size_t size, char* block,
+                        Callback callback) override;
+
+  void write_block_async(const char* block, size_t offset, size_t size,
+                         Callback callback) override;
+
+  size_t poll(size_t min_completions = 0) override;
+
+  size_t in_flight() const override;
+
+ private:
+  struct Ring;
+  struct Request;
+
+  std::unique_ptr<Ring> ring;
+  /// Guards `ring` and `pending`.
+  mutable std::mutex mutex;
+  /// Requests submitted but not reaped yet.
+  size_t pending = 0;
+
+  /// Queues `request` in the submission ring and tells the kernel about it.
+  /// Reaps completions into `done` first when the ring is full. A request
+  /// the kernel refuses, or that cannot be queued because reaping failed,
+  /// is moved to `done` with the error instead. Never throws.
+  void submit(Request* request, std::vector<Request*>& done);
+
+  /// Moves finished requests from the completion ring to `done`, waiting
+  /// for at least `min_completions`. Partial transfers are resubmitted.
+  void reap(size_t min_completions, std::vector<Request*>& done);
+
+  /// Runs the callbacks of `done` and frees the requests.
+  static void complete(std::vector<Request*>& done);
+};
+
+}  // namespace buzzdb
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+#include "storage/file.h"
+
+namespace buzzdb {
+
+///
+/// `File` on top of a POSIX file descriptor with blocking `pread`/`pwrite`.
+///
+class PosixFile : public File {
+ protected:
+  Mode mode;
+  int fd;
+  size_t cached_size;
+  /// Opened with O_DIRECT.
+  bool direct_io = false;
+
+  size_t read_size();
+
+ public:
+  PosixFile(Mode mode, int fd, size_t size);
+
+  PosixFile(const char* filename, Mode mode, const OpenOptions& options = {});
+
+  ~PosixFile() override;
+
+  Mode get_mode() const override;
+
+  size_t size() const override;
+
+  void resize(size_t new_size) override;
+
+  void read_block(size_t offset, size_t size, char* block) override;
+
+  void write_block(const char* block, size_t offset, size_t size) override;
+
+  void sync() override;
+};
+
+}  // namespace buzzdb
@@ -0,0 +1,52 @@
+#include "storage/file_cache.h"
+
+#include <utility>
+
+namespace buzzdb {
+
+FileCache::FileCache(size_t max_open_files, Opener opener)
+    : max_open_files(max_open_files), opener(std::move(opener)) {}
+
+std::shared_ptr<File> FileCache::get(uint16_t segment_id) {
+  std::shared_ptr<File> evicted;
+  std::unique_lock lock(mutex);
+  auto it = files.find(segment_id);
+  if (it != files.end()) {
+    lru.splice(lru.end(), lru, it->second.lru_position);
+    return it->second.file;
+  }
+
+  // Opening takes syscalls, so do not hold up lookups of other segments.
+  lock.unlock();
+  std::shared_ptr<File> file = opener(segment_id);
+  lock.lock();
+  it = files.find(segment_id);
+  if (it != files.end()) {
+    // Another thread opened the segment meanwhile. Ours is closed outside
+    // the latch.
+    lru.splice(lru.end(), lru, it->second.lru_position);
+    evicted = std::move(file);
+    file = it->second.file;
+    lock.unlock();
+    return file;
+  }
+  if (files.size() >= max_open_files && !lru.empty()) {
+    // Only drop our reference here; the file is closed once the last
+    // in-flight I/O on it is done. Let that happen outside the latch.
+    auto victim = files.find(lru.front());
+    evicted = std::move(victim->second.file);
+    files.erase(victim);
+    lru.pop_front();
+  }
+  lru.push_back(segment_id);
+  files.emplace(segment_id, Entry{file, std::prev(lru.end())});
+  lock.unlock();
+  return file;
+}
+
+size_t FileCache::size() const {
+  std::unique_lock lock(mutex);
+  return files.size();
+}
+
+}  // namespace buzzdb
@@ -0,0 +1,355 @@
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "storage/io_uring_file.h"
+
+namespace buzzdb {
+
+namespace {
+
+[[noreturn]] void throw_errno() {
+  throw std::system_error{errno, std::system_category()};
+}
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                   unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+/// Shared memory of one io_uring instance.
+struct IoUringFile::Ring {
+  int fd = -1;
+  unsigned entries = 0;
+
+  void* sq_memory = MAP_FAILED;
+  size_t sq_memory_size = 0;
+  void* cq_memory = MAP_FAILED;
+  size_t cq_memory_size = 0;
+  io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size = 0;
+
+  unsigned* sq_tail = nullptr;
+  unsigned* sq_mask = nullptr;
+  unsigned* sq_array = nullptr;
+  unsigned* cq_head = nullptr;
+  unsigned* cq_tail = nullptr;
+  unsigned* cq_mask = nullptr;
+  io_uring_cqe* cqes = nullptr;
+
+  explicit Ring(unsigned queue_depth) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd = io_uring_setup(std::max(queue_depth, 1u), &params);
+    if (fd < 0) {
+      throw_errno();
+    }
+    entries = params.sq_entries;
+
+    sq_memory_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_memory_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_memory_size = cq_memory_size =
+          std::max(sq_memory_size, cq_memory_size);
+    }
+    sq_memory = ::mmap(nullptr, sq_memory_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_memory == MAP_FAILED) {
+      release();
+      throw_errno();
+    }
+    if (single_mmap) {
+      cq_memory = sq_memory;
+    } else {
+      cq_memory = ::mmap(nullptr, cq_memory_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_memory == MAP_FAILED) {
+        release();
+        throw_errno();
+      }
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(
+        ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED) {
+      release();
+      throw_errno();
+    }
+
+    auto* sq = static_cast<char*>(sq_memory);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<char*>(cq_memory);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  }
+
+  ~Ring() { release(); }
+
+  void release() {
+    if (sqes != MAP_FAILED) {
+      ::munmap(sqes, sqes_size);
+    }
+    if (cq_memory != MAP_FAILED && cq_memory != sq_memory) {
+      ::munmap(cq_memory, cq_memory_size);
+    }
+    if (sq_memory != MAP_FAILED) {
+      ::munmap(sq_memory, sq_memory_size);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+/// An asynchronous read or write together with its progress.
+struct IoUringFile::Request {
+  bool write;
+  char* block;
+  size_t offset;
+  size_t size;
+  size_t done = 0;
+  /// Error reported to the callback, 0 on success.
+  int error = 0;
+  Callback callback;
+  /// Describes the part of `block` that is still to be transferred.
+  iovec vector = {};
+
+  Request(bool write, char* block, size_t offset, size_t size,
+          Callback callback)
+      : write(write),
+        block(block),
+        offset(offset),
+        size(size),
+        callback(std::move(callback)) {}
+};
+
+bool IoUringFile::is_supported() {
+  static const bool supported = [] {
+    try {
+      Ring ring{1};
+      return true;
+    } catch (const std::system_error&) {
+      return false;
+    }
+  }();
+  return supported;
+}
+
+IoUringFile::IoUringFile(const char* filename, Mode mode,
+                         const OpenOptions& options, unsigned queue_depth)
+    : PosixFile(filename, mode, options),
+      ring(std::make_unique<Ring>(queue_depth)) {}
+
+IoUringFile::~IoUringFile() {
+  // The kernel may still write into the requests' buffers, so wait for
+  // everything that is in flight.
+  while (in_flight() != 0) {
+    poll(1);
+  }
+}
+
+void IoUringFile::read_block_async(size_t offset, size_t size, char* block,
+                                   Callback callback) {
+  auto* request = new Request{false, block, offset, size, std::move(callback)};
+  std::vector<Request*> done;
+  {
+    std::unique_lock lock(mutex);
+    submit(request, done);
+  }
+  complete(done);
+}
+
+void IoUringFile::write_block_async(const char* block, size_t offset,
+                                    size_t size, Callback callback) {
+  auto* request = new Request{true, const_cast<char*>(block), offset, size,
+                              std::move(callback)};
+  std::vector<Request*> done;
+  {
+    std::unique_lock lock(mutex);
+    submit(request, done);
+  }
+  complete(done);
+}
+
+size_t IoUringFile::poll(size_t min_completions) {
+  std::vector<Request*> done;
+  try {
+    std::unique_lock lock(mutex);
+    reap(min_completions, done);
+  } catch (...) {
+    // Requests that finished before the error are still reported.
+    complete(done);
+    throw;
+  }
+  size_t completed = done.size();
+  complete(done);
+  return completed;
+}
+
+size_t IoUringFile::in_flight() const {
+  std::unique_lock lock(mutex);
+  return pending;
+}
+
+void IoUringFile::submit(Request* request, std::vector<Request*>& done) {
+  // Gives up on an enter that makes no progress while nothing is in flight
+  // that could be reaped instead.
+  constexpr size_t maxIdleRetries = 1000;
+  try {
+    while (pending >= ring->entries) {
+      reap(1, done);
+    }
+  } catch (const std::system_error& e) {
+    request->error = e.code().value();
+    done.push_back(request);
+    return;
+  }
+  request->vector.iov_base = request->block + request->done;
+  request->vector.iov_len = request->size - request->done;
+
+  size_t idleRetries = 0;
+  while (true) {
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    io_uring_sqe* sqe = &ring->sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = request->write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = request->offset + request->done;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->vector);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<uint64_t>(request);
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int submitted = io_uring_enter(ring->fd, 1, 0, 0);
+    if (submitted > 0) {
+      pending++;
+      return;
+    }
+    // The kernel did not take the entry. Withdraw it so that a later enter
+    // does not submit a request the caller has been told about already.
+    int error = submitted == 0 ? EAGAIN : errno;
+    __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+    if (error == EINTR) {
+      continue;
+    }
+    if (error == EBUSY || error == EAGAIN) {
+      // The completion ring is full or the kernel is short of resources.
+      // Finished requests free both, so wait for one before trying again.
+      if (pending > 0) {
+        try {
+          reap(1, done);
+        } catch (const std::system_error& e) {
+          error = e.code().value();
+        }
+        if (error == EBUSY || error == EAGAIN) {
+          continue;
+        }
+      } else if (++idleRetries < maxIdleRetries) {
+        std::this_thread::yield();
+        continue;
+      }
+    }
+    request->error = error;
+    done.push_back(request);
+    return;
+  }
+}
+
+void IoUringFile::reap(size_t min_completions, std::vector<Request*>& done) {
+  size_t reaped = 0;
+  while (pending > 0) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      if (reaped >= min_completions) {
+        return;
+      }
+      if (io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+          errno != EINTR) {
+        throw_errno();
+      }
+      continue;
+    }
+
+    io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+    auto* request = reinterpret_cast<Request*>(cqe->user_data);
+    int result = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    pending--;
+
+    if (result < 0) {
+      request->error = -result;
+    } else if (result == 0) {
+      // Same as the pread loop: end of file for reads, and a write that
+      // makes no progress is given up instead of retried forever.
+      if (!request->write) {
+        std::memset(request->block + request->done, 0,
+                    request->size - request->done);
+      }
+    } else {
+      request->done += static_cast<size_t>(result);
+      if (request->done < request->size && direct_io && !request->write) {
+        // End of file; the rest could not be read with an aligned offset
+        // anyway.
+        std::memset(request->block + request->done, 0,
+                    request->size - request->done);
+      } else if (request->done < request->size) {
+        // Partial transfer, queue the rest. There is room in the ring as
+        // this request's slot was just freed.
+        submit(request, done);
+        continue;
+      }
+    }
+    done.push_back(request);
+    reaped++;
+  }
+}
+
+void IoUringFile::complete(std::vector<Request*>& done) {
+  for (Request* request : done) {
+    std::unique_ptr<Request> owned{request};
+    owned->callback(owned->error);
+  }
+  done.clear();
+}
+
+std::unique_ptr<File> File::open_async_file(const char* filename, Mode mode,
+                                            unsigned queue_depth) {
+  return open_async_file(filename, mode, OpenOptions(), queue_depth);
+}
+
+std::unique_ptr<File> File::open_async_file(const char* filename, Mode mode,
+                                            const OpenOptions& options,
+                                            unsigned queue_depth) {
+  if (IoUringFile::is_supported()) {
+    return std::make_unique<IoUringFile>(filename, mode, options, queue_depth);
+  }
+  return open_file(filename, mode, options);
+}
+
+}  // namespace buzzdb
@@ -5,10 +5,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <cerrno>
+#include <cstring>
 #include <memory>
 #include <system_error>
 
-#include "storage/file.h"
+#include "storage/posix_file.h"
 
 namespace buzzdb {
 
@@ -20,100 +21,142 @@ namespace {
 
 }  // namespace
 
-class PosixFile : public File {
- private:
-  Mode mode;
-  int fd;
-  size_t cached_size;
-
-  size_t read_size() {
-    struct ::stat file_stat;
-    if (::fstat(fd, &file_stat) < 0) {
-      throw_errno();
-    }
-    return file_stat.st_size;
+size_t PosixFile::read_size() {
+  struct ::stat file_stat;
+  if (::fstat(fd, &file_stat) < 0) {
+    throw_errno();
   }
+  return file_stat.st_size;
+}
 
- public:
-  PosixFile(Mode mode, int fd, size_t size)
-      : mode(mode), fd(fd), cached_size(size) {}
-
-  PosixFile(const char* filename, Mode mode) : mode(mode) {
-    switch (mode) {
-      case READ:
-        fd = ::open(filename, O_RDONLY | O_SYNC);
-        break;
-      case WRITE:
-        fd = ::open(filename, O_RDWR | O_CREAT | O_SYNC, 0666);
-    }
-    if (fd < 0) {
-      throw_errno();
-    }
-    cached_size = read_size();
-  }
+PosixFile::PosixFile(Mode mode, int fd, size_t size)
+    : mode(mode), fd(fd), cached_size(size) {}
 
-  ~PosixFile() override {
-    // Don't check return value here, as we don't want a throwing
-    // destructor. Also, even when close() fails, the fd will always be
-    // freed (see man 2 close).
-    ::close(fd);
+PosixFile::PosixFile(const char* filename, Mode mode,
+                     const OpenOptions& options)
+    : mode(mode), direct_io(options.direct_io) {
+  int flags = 0;
+  if (options.sync_writes) {
+    flags |= O_SYNC;
+  }
+  if (options.direct_io) {
+    flags |= O_DIRECT;
   }
+  switch (mode) {
+    case READ:
+      fd = ::open(filename, O_RDONLY | flags);
+      break;
+    case WRITE:
+      fd = ::open(filename, O_RDWR | O_CREAT | flags, 0666);
+  }
+  if (fd < 0) {
+    throw_errno();
+  }
+  cached_size = read_size();
+}
 
-  Mode get_mode() const override { return mode; }
+PosixFile::~PosixFile() {
+  // Don't check return value here, as we don't want a throwing
+  // destructor. Also, even when close() fails, the fd will always be
+  // freed (see man 2 close).
+  ::close(fd);
+}
+
+File::Mode PosixFile::get_mode() const { return mode; }
 
-  size_t size() const override { return cached_size; }
+size_t PosixFile::size() const { return cached_size; }
 
-  void resize(size_t new_size) override {
-    if (new_size == cached_size) {
+void PosixFile::resize(size_t new_size) {
+  if (new_size == cached_size) {
+    return;
+  }
+  if (::ftruncate(fd, new_size) < 0) {
+    throw_errno();
+  }
+  cached_size = new_size;
+}
+
+void PosixFile::read_block(size_t offset, size_t size, char* block) {
+  size_t total_bytes_read = 0;
+  while (total_bytes_read < size) {
+    ssize_t bytes_read =
+        ::pread(fd, block + total_bytes_read, size - total_bytes_read,
+                offset + total_bytes_read);
+    if (bytes_read == 0) {
+      // end of file, i.e. size was probably larger than the file
+      // size. Callers reuse their buffers, so don't leave stale bytes
+      // behind in the part that does not exist on disk.
+      std::memset(block + total_bytes_read, 0, size - total_bytes_read);
       return;
     }
-    if (::ftruncate(fd, new_size) < 0) {
+    if (bytes_read < 0) {
       throw_errno();
     }
-    cached_size = new_size;
+    total_bytes_read += static_cast<size_t>(bytes_read);
+    if (direct_io && total_bytes_read < size) {
+      // Short reads of regular files only happen at the end of the file.
+      // Don't issue another read, as its offset would not be aligned.
+      std::memset(block + total_bytes_read, 0, size - total_bytes_read);
+      return;
+    }
   }
+}
 
-  void read_block(size_t offset, size_t size, char* block) override {
-    size_t total_bytes_read = 0;
-    while (total_bytes_read < size) {
-      ssize_t bytes_read =
-          ::pread(fd, block + total_bytes_read, size - total_bytes_read,
-                  offset + total_bytes_read);
-      if (bytes_read == 0) {
-        // end of file, i.e. size was probably larger than the file
-        // size
-        return;
-      }
-      if (bytes_read < 0) {
-        throw_errno();
-      }
-      total_bytes_read += static_cast<size_t>(bytes_read);
+void PosixFile::write_block(const char* block, size_t offset, size_t size) {
+  size_t total_bytes_written = 0;
+  while (total_bytes_written < size) {
+    ssize_t bytes_written =
+        ::pwrite(fd, block + total_bytes_written, size - total_bytes_written,
+                 offset + total_bytes_written);
+    if (bytes_written == 0) {
+      // This should probably never happen. Return here to prevent
+      // an infinite loop.
+      return;
+    }
+    if (bytes_written < 0) {
+      throw_errno();
     }
+    total_bytes_written += static_cast<size_t>(bytes_written);
   }
+}
 
-  void write_block(const char* block, size_t offset, size_t size) override {
-    size_t total_bytes_written = 0;
-    while (total_bytes_written < size) {
-      ssize_t bytes_written =
-          ::pwrite(fd, block + total_bytes_written, size - total_bytes_written,
-                   offset + total_bytes_written);
-      if (bytes_written == 0) {
-        // This should probably never happen. Return here to prevent
-        // an infinite loop.
-        return;
-      }
-      if (bytes_written < 0) {
-        throw_errno();
-      }
-      total_bytes_written += static_cast<size_t>(bytes_written);
-    }
+void PosixFile::sync() {
+  if (::fdatasync(fd) < 0) {
+    throw_errno();
+  }
+}
+
+void File::read_block_async(size_t offset, size_t size, char* block,
+                            Callback callback) {
+  int error = 0;
+  try {
+    read_block(offset, size, block);
+  } catch (const std::system_error& e) {
+    error = e.code().value();
+  }
+  callback(error);
+}
+
+void File::write_block_async(const char* block, size_t offset, size_t size,
+                             Callback callback) {
+  int error = 0;
+  try {
+    write_block(block, offset, size);
+  } catch (const std::system_error& e) {
+    error = e.code().value();
   }
-};
+  callback(error);
+}
 
 std::unique_ptr<File> File::open_file(const char* filename, Mode mode) {
   return std::make_unique<PosixFile>(filename, mode);
 }
 
+std::unique_ptr<File> File::open_file(const char* filename, Mode mode,
+                                      const OpenOptions& options) {
+  return std::make_unique<PosixFile>(filename, mode, options);
+}
+
 std::unique_ptr<File> File::make_temporary_file() {
   char file_template[] = ".tmpfile-XXXXXX";
   int fd = ::mkstemp(file_template);
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_manager.h"
+
+namespace {
+
+constexpr size_t PAGE_COUNT = 1 << 12;
+
+/// Zipf-distributed fixes over four times as many pages as fit into the
+/// pool, so a good share of the fixes miss. The first argument selects the
+/// policy, the second the cooling share in percent of the frames. With a
+/// cooling stage most misses pop a pre-filled free frame, and pages used
+/// again while cooling are rescued without a read.
+void BM_ZipfMisses(benchmark::State& state) {
+    constexpr size_t PAGES = 4 * PAGE_COUNT;
+    buzzdb::BufferManagerOptions options;
+    options.replacement_policy = static_cast<buzzdb::ReplacementPolicyType>(state.range(0));
+    options.cooling_ratio = state.range(1) / 100.0;
+    buzzdb::BufferManager buffer_manager{64, PAGE_COUNT, options};
+
+    std::vector<double> weights(PAGES);
+    for (size_t i = 0; i < PAGES; ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+    std::mt19937_64 engine{42};
+    std::discrete_distribution<uint64_t> zipf{weights.begin(), weights.end()};
+    std::vector<uint64_t> trace(16 * PAGE_COUNT);
+    for (auto& page_id : trace) {
+        page_id = zipf(engine);
+    }
+
+    uint64_t missesBefore = buffer_manager.get_stats().misses;
+    for (auto _ : state) {
+        for (uint64_t page_id : trace) {
+            auto& page = buffer_manager.fix_page(page_id, false);
+            buffer_manager.unfix_page(page, false);
+        }
+    }
+    uint64_t accesses = state.iterations() * trace.size();
+    uint64_t misses = buffer_manager.get_stats().misses - missesBefore;
+    state.SetItemsProcessed(accesses);
+    state.counters["hit_ratio"] = 1.0 - static_cast<double>(misses) / accesses;
+    state.counters["rescues"] = buffer_manager.get_stats().cooling_rescues;
+}
+
+void PoliciesAndCooling(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"policy", "cooling_pct"});
+    for (auto policy : {buzzdb::ReplacementPolicyType::TWO_QUEUE,
+                        buzzdb::ReplacementPolicyType::CLOCK,
+                        buzzdb::ReplacementPolicyType::ARC,
+                        buzzdb::ReplacementPolicyType::LRU_K}) {
+        for (int64_t cooling : {0, 10}) {
+            benchmark->Args({static_cast<int64_t>(policy), cooling});
+        }
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ZipfMisses)->Apply(PoliciesAndCooling)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
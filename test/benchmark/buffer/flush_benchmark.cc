@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#include "buffer/buffer_manager.h"
+
+namespace {
+
+constexpr size_t PAGE_SIZE = 4096;
+constexpr size_t PAGE_COUNT = 1024;
+
+/// Dirties every page of the pool and writes them all back with flush_all().
+/// With `sync_each_write` every write waits for the device; without it the
+/// flush issues one fdatasync per segment at the end.
+void BM_FlushAll(benchmark::State& state) {
+    buzzdb::BufferManagerOptions options;
+    options.sync_each_write = state.range(0) != 0;
+    buzzdb::BufferManager buffer_manager{PAGE_SIZE, PAGE_COUNT, options};
+
+    uint64_t round = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        ++round;
+        for (uint64_t page_id = 0; page_id < PAGE_COUNT; ++page_id) {
+            auto& page = buffer_manager.fix_page(page_id, true);
+            std::memcpy(page.get_data(), &round, sizeof(round));
+            buffer_manager.unfix_page(page, true);
+        }
+        state.ResumeTiming();
+        buffer_manager.flush_all();
+    }
+    state.SetItemsProcessed(state.iterations() * PAGE_COUNT);
+    state.SetBytesProcessed(state.iterations() * PAGE_COUNT * PAGE_SIZE);
+}
+
+/// Uniform fixes over four times as many pages as fit into the pool, every
+/// fourth one exclusive and dirtying the page. The argument is the clean
+/// victim window. "foreground_writes" is the share of misses that had to
+/// wait for the write of a dirty victim.
+void BM_DirtyMisses(benchmark::State& state) {
+    constexpr size_t FIXES = 1 << 14;
+    buzzdb::BufferManagerOptions options;
+    options.clean_victim_window = state.range(0);
+    buzzdb::BufferManager buffer_manager{PAGE_SIZE, PAGE_COUNT, options};
+
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<uint64_t> distr{0, 4 * PAGE_COUNT - 1};
+    auto before = buffer_manager.get_stats();
+    for (auto _ : state) {
+        for (size_t i = 0; i < FIXES; ++i) {
+            bool exclusive = i % 4 == 0;
+            auto& page = buffer_manager.fix_page(distr(engine), exclusive);
+            buffer_manager.unfix_page(page, exclusive);
+        }
+    }
+    auto after = buffer_manager.get_stats();
+    state.SetItemsProcessed(state.iterations() * FIXES);
+    state.counters["foreground_writes"] =
+        static_cast<double>(after.foreground_writebacks - before.foreground_writebacks) /
+        (after.misses - before.misses);
+}
+
+}  // namespace
+
+BENCHMARK(BM_FlushAll)->ArgName("sync_each_write")->Arg(1)->Arg(0)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_DirtyMisses)->ArgName("clean_victim_window")->Arg(0)->Arg(8)->Arg(32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
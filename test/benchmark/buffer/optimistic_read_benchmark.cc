@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_manager.h"
+
+namespace {
+
+constexpr size_t PAGE_COUNT = 1 << 10;
+constexpr size_t READS_PER_THREAD = 1 << 16;
+
+/// Parallel reads of one word from resident pages, most of them from a few
+/// hot pages like the upper levels of a B-tree. The first argument is the
+/// thread count. The second selects shared fixes (0), which latch the
+/// partition and the page, or optimistic reads (1), which write no shared
+/// memory.
+void BM_ParallelReads(benchmark::State& state) {
+    size_t thread_count = state.range(0);
+    bool optimistic = state.range(1) != 0;
+    buzzdb::BufferManager buffer_manager{64, PAGE_COUNT};
+    for (uint64_t page_id = 0; page_id < PAGE_COUNT; ++page_id) {
+        auto& page = buffer_manager.fix_page(page_id, true);
+        *reinterpret_cast<uint64_t*>(page.get_data()) = page_id;
+        buffer_manager.unfix_page(page, true);
+    }
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back([i, optimistic, &buffer_manager] {
+                std::mt19937_64 engine{i};
+                std::geometric_distribution<uint64_t> distr{0.1};
+                uint64_t sum = 0;
+                for (size_t j = 0; j < READS_PER_THREAD; ++j) {
+                    uint64_t page_id = distr(engine) % PAGE_COUNT;
+                    if (optimistic) {
+                        sum += buffer_manager.read_page(page_id, [](const char* data) {
+                            return *reinterpret_cast<const uint64_t*>(data);
+                        });
+                    } else {
+                        auto& page = buffer_manager.fix_page(page_id, false);
+                        sum += *reinterpret_cast<const uint64_t*>(page.get_data());
+                        buffer_manager.unfix_page(page, false);
+                    }
+                }
+                benchmark::DoNotOptimize(sum);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * thread_count * READS_PER_THREAD);
+}
+
+void ThreadsAndModes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"threads", "optimistic"});
+    for (int64_t optimistic : {0, 1}) {
+        for (int64_t threads = 1; threads <= 16; threads *= 2) {
+            benchmark->Args({threads, optimistic});
+        }
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ParallelReads)
+    ->Apply(ThreadsAndModes)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_manager.h"
+#include "buffer/page_table.h"
+
+namespace {
+
+/// Page ids spread over a few segments, like a real pool would hold them.
+std::vector<uint64_t> make_page_ids(size_t count) {
+    std::vector<uint64_t> page_ids;
+    page_ids.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t segment = i % 4;
+        page_ids.push_back((segment << 48) | (i / 4));
+    }
+    return page_ids;
+}
+
+/// Random probe order, so the lookups do not walk the tree in key order.
+std::vector<uint64_t> make_probes(const std::vector<uint64_t>& page_ids) {
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<size_t> distr{0, page_ids.size() - 1};
+    std::vector<uint64_t> probes(1 << 16);
+    for (auto& probe : probes) {
+        probe = page_ids[distr(engine)];
+    }
+    return probes;
+}
+
+void BM_StdMapLookup(benchmark::State& state) {
+    auto page_ids = make_page_ids(state.range(0));
+    std::map<uint64_t, buzzdb::BufferFrame*> mapping;
+    for (auto page_id : page_ids) {
+        mapping.emplace(page_id, nullptr);
+    }
+    auto probes = make_probes(page_ids);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mapping.find(probes[i++ & 0xffff]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PageTableLookup(benchmark::State& state) {
+    auto page_ids = make_page_ids(state.range(0));
+    buzzdb::PageTable table{page_ids.size()};
+    for (auto page_id : page_ids) {
+        table.insert(page_id, nullptr);
+    }
+    auto probes = make_probes(page_ids);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.find(probes[i++ & 0xffff]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Hit path of the buffer manager: every page is resident, so each iteration
+/// is one lookup plus the replacement bookkeeping and the page latch.
+void BM_FixPageHit(benchmark::State& state) {
+    size_t page_count = state.range(0);
+    buzzdb::BufferManager buffer_manager{64, page_count};
+    for (uint64_t page_id = 0; page_id < page_count; ++page_id) {
+        auto& page = buffer_manager.fix_page(page_id, false);
+        buffer_manager.unfix_page(page, false);
+    }
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<uint64_t> distr{0, page_count - 1};
+    std::vector<uint64_t> probes(1 << 16);
+    for (auto& probe : probes) {
+        probe = distr(engine);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        auto& page = buffer_manager.fix_page(probes[i++ & 0xffff], false);
+        buffer_manager.unfix_page(page, false);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_StdMapLookup)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_PageTableLookup)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_FixPageHit)->RangeMultiplier(4)->Range(1 << 8, 1 << 12);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_manager.h"
+
+namespace {
+
+constexpr size_t PAGE_COUNT = 1 << 12;
+/// Half the pool, so that uneven hashing never overflows a partition.
+constexpr size_t WORKING_SET = PAGE_COUNT / 2;
+constexpr size_t FIXES_PER_THREAD = 1 << 16;
+
+/// Every iteration runs `threads` workers that fix and unfix random resident
+/// pages, so the measured time is dominated by latch contention on the hit
+/// path. Compare the rows with one partition against the partitioned ones.
+void BM_ParallelFixPage(benchmark::State& state) {
+    size_t thread_count = state.range(0);
+    buzzdb::BufferManagerOptions options;
+    options.partition_count = state.range(1);
+    buzzdb::BufferManager buffer_manager{64, PAGE_COUNT, options};
+    for (uint64_t page_id = 0; page_id < WORKING_SET; ++page_id) {
+        auto& page = buffer_manager.fix_page(page_id, false);
+        buffer_manager.unfix_page(page, false);
+    }
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back([i, &buffer_manager] {
+                std::mt19937_64 engine{i};
+                std::uniform_int_distribution<uint64_t> distr{0, WORKING_SET - 1};
+                for (size_t j = 0; j < FIXES_PER_THREAD; ++j) {
+                    auto& page = buffer_manager.fix_page(distr(engine), false);
+                    buffer_manager.unfix_page(page, false);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * thread_count * FIXES_PER_THREAD);
+}
+
+void ThreadsAndPartitions(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"threads", "partitions"});
+    for (int64_t partitions : {1, 64}) {
+        for (int64_t threads = 1; threads <= 32; threads *= 2) {
+            benchmark->Args({threads, partitions});
+        }
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ParallelFixPage)
+    ->Apply(ThreadsAndPartitions)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,242 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_manager.h"
+
+namespace {
+
+constexpr size_t PAGE_COUNT = 1 << 12;
+constexpr size_t FIXES_PER_THREAD = 1 << 16;
+
+/// Parallel fixes of resident pages in a single partition. With 2Q every hit
+/// relinks a queue under the queue latch; with CLOCK it only sets a reference
+/// bit.
+void BM_ParallelHits(benchmark::State& state) {
+    size_t thread_count = state.range(0);
+    buzzdb::BufferManagerOptions options;
+    options.replacement_policy = static_cast<buzzdb::ReplacementPolicyType>(state.range(1));
+    buzzdb::BufferManager buffer_manager{64, PAGE_COUNT, options};
+    for (uint64_t page_id = 0; page_id < PAGE_COUNT; ++page_id) {
+        auto& page = buffer_manager.fix_page(page_id, false);
+        buffer_manager.unfix_page(page, false);
+    }
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back([i, &buffer_manager] {
+                std::mt19937_64 engine{i};
+                std::uniform_int_distribution<uint64_t> distr{0, PAGE_COUNT - 1};
+                for (size_t j = 0; j < FIXES_PER_THREAD; ++j) {
+                    auto& page = buffer_manager.fix_page(distr(engine), false);
+                    buffer_manager.unfix_page(page, false);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * thread_count * FIXES_PER_THREAD);
+}
+
+void ThreadsAndPolicies(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"threads", "policy"});
+    for (auto policy : {buzzdb::ReplacementPolicyType::TWO_QUEUE,
+                        buzzdb::ReplacementPolicyType::CLOCK,
+                        buzzdb::ReplacementPolicyType::ARC,
+                        buzzdb::ReplacementPolicyType::LRU_K,
+                        buzzdb::ReplacementPolicyType::SAMPLED_LRU}) {
+        for (int64_t threads = 1; threads <= 16; threads *= 2) {
+            benchmark->Args({threads, static_cast<int64_t>(policy)});
+        }
+    }
+}
+
+/// Fixes every page of `trace` in turn. The first argument selects the
+/// policy, the second enables the TinyLFU admission filter. The "hit_ratio"
+/// counter is the share of fixes that did not read from disk.
+void runTrace(benchmark::State& state, const std::vector<uint64_t>& trace) {
+    buzzdb::BufferManagerOptions options;
+    options.replacement_policy = static_cast<buzzdb::ReplacementPolicyType>(state.range(0));
+    options.admission_filter = state.range(1) != 0;
+    buzzdb::BufferManager buffer_manager{64, PAGE_COUNT, options};
+
+    uint64_t missesBefore = buffer_manager.get_stats().misses;
+    for (auto _ : state) {
+        for (uint64_t page_id : trace) {
+            auto& page = buffer_manager.fix_page(page_id, false);
+            buffer_manager.unfix_page(page, false);
+        }
+    }
+    uint64_t accesses = state.iterations() * trace.size();
+    uint64_t misses = buffer_manager.get_stats().misses - missesBefore;
+    state.SetItemsProcessed(accesses);
+    state.counters["hit_ratio"] = 1.0 - static_cast<double>(misses) / accesses;
+}
+
+/// Hot-set accesses mixed with long scans over pages that are never used
+/// again. Half way through, the hot set moves, so the policy has to shed the
+/// old one.
+std::vector<uint64_t> makeScanAndHotSetTrace() {
+    constexpr size_t HOT_SET = PAGE_COUNT * 3 / 4;
+    constexpr size_t SCAN_LENGTH = PAGE_COUNT / 2;
+    constexpr uint64_t SCAN_BASE = 1 << 20;
+    std::vector<uint64_t> trace;
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<uint64_t> hot{0, HOT_SET - 1};
+    uint64_t scanPage = SCAN_BASE;
+    for (size_t phase = 0; phase < 2; ++phase) {
+        for (size_t round = 0; round < 16; ++round) {
+            for (size_t i = 0; i < 4 * PAGE_COUNT; ++i) {
+                trace.push_back(phase * HOT_SET + hot(engine));
+            }
+            for (size_t i = 0; i < SCAN_LENGTH; ++i) {
+                trace.push_back(scanPage++);
+            }
+        }
+    }
+    return trace;
+}
+
+void BM_ScanAndHotSet(benchmark::State& state) {
+    static const std::vector<uint64_t> trace = makeScanAndHotSetTrace();
+    runTrace(state, trace);
+}
+
+/// Half of the accesses follow a Zipf distribution over eight times as many
+/// pages as fit into the pool, the other half go to pages that are never
+/// accessed again.
+std::vector<uint64_t> makeOneHitWonderTrace() {
+    constexpr size_t POPULAR_PAGES = 8 * PAGE_COUNT;
+    constexpr uint64_t ONE_HIT_BASE = 1 << 20;
+    std::vector<double> weights(POPULAR_PAGES);
+    for (size_t i = 0; i < POPULAR_PAGES; ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+    std::mt19937_64 engine{42};
+    std::discrete_distribution<uint64_t> zipf{weights.begin(), weights.end()};
+    std::bernoulli_distribution oneHit{0.5};
+    std::vector<uint64_t> trace;
+    uint64_t oneHitPage = ONE_HIT_BASE;
+    for (size_t i = 0; i < 64 * PAGE_COUNT; ++i) {
+        trace.push_back(oneHit(engine) ? oneHitPage++ : zipf(engine));
+    }
+    return trace;
+}
+
+void BM_OneHitWonders(benchmark::State& state) {
+    static const std::vector<uint64_t> trace = makeOneHitWonderTrace();
+    runTrace(state, trace);
+}
+
+void PoliciesAndAdmission(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"policy", "admission"});
+    for (int64_t admission : {0, 1}) {
+        for (int64_t policy = 0;
+                policy <= static_cast<int64_t>(buzzdb::ReplacementPolicyType::SAMPLED_LRU);
+                ++policy) {
+            benchmark->Args({policy, admission});
+        }
+    }
+}
+
+void PoliciesAndFrames(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"policy", "frames"});
+    for (auto policy : {buzzdb::ReplacementPolicyType::TWO_QUEUE,
+                        buzzdb::ReplacementPolicyType::LRU_K,
+                        buzzdb::ReplacementPolicyType::SAMPLED_LRU}) {
+        for (int64_t frames : {1 << 12, 1 << 20}) {
+            benchmark->Args({static_cast<int64_t>(policy), frames});
+        }
+    }
+}
+
+/// Zipf-distributed accesses over eight times as many pages as fit into the
+/// pool. The argument is the sample size of sampled LRU; zero runs exact LRU
+/// (LRU-K with K = 1) for comparison.
+void BM_SampledLruAccuracy(benchmark::State& state) {
+    constexpr size_t PAGES = 8 * PAGE_COUNT;
+    static const std::vector<uint64_t> trace = [] {
+        std::vector<double> weights(PAGES);
+        for (size_t i = 0; i < PAGES; ++i) {
+            weights[i] = 1.0 / (i + 1);
+        }
+        std::mt19937_64 engine{42};
+        std::discrete_distribution<uint64_t> zipf{weights.begin(), weights.end()};
+        std::vector<uint64_t> result(32 * PAGE_COUNT);
+        for (auto& page_id : result) {
+            page_id = zipf(engine);
+        }
+        return result;
+    }();
+
+    buzzdb::BufferManagerOptions options;
+    if (state.range(0) == 0) {
+        options.replacement_policy = buzzdb::ReplacementPolicyType::LRU_K;
+        options.lru_k = 1;
+    } else {
+        options.replacement_policy = buzzdb::ReplacementPolicyType::SAMPLED_LRU;
+        options.sampled_lru_sample_size = state.range(0);
+    }
+    buzzdb::BufferManager buffer_manager{64, PAGE_COUNT, options};
+
+    uint64_t missesBefore = buffer_manager.get_stats().misses;
+    for (auto _ : state) {
+        for (uint64_t page_id : trace) {
+            auto& page = buffer_manager.fix_page(page_id, false);
+            buffer_manager.unfix_page(page, false);
+        }
+    }
+    uint64_t accesses = state.iterations() * trace.size();
+    uint64_t misses = buffer_manager.get_stats().misses - missesBefore;
+    state.SetItemsProcessed(accesses);
+    state.counters["hit_ratio"] = 1.0 - static_cast<double>(misses) / accesses;
+}
+
+/// Every fix misses and evicts a page, so this measures victim selection and
+/// bookkeeping on the miss path as the pool grows.
+void BM_EvictEveryFix(benchmark::State& state) {
+    buzzdb::BufferManagerOptions options;
+    options.replacement_policy = static_cast<buzzdb::ReplacementPolicyType>(state.range(0));
+    size_t frame_count = state.range(1);
+    buzzdb::BufferManager buffer_manager{64, frame_count, options};
+    uint64_t page_id = 0;
+    for (; page_id < frame_count; ++page_id) {
+        auto& page = buffer_manager.fix_page(page_id, false);
+        buffer_manager.unfix_page(page, false);
+    }
+
+    for (auto _ : state) {
+        auto& page = buffer_manager.fix_page(page_id++, false);
+        buffer_manager.unfix_page(page, false);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_EvictEveryFix)
+    ->Apply(PoliciesAndFrames);
+
+BENCHMARK(BM_ScanAndHotSet)
+    ->Apply(PoliciesAndAdmission)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_OneHitWonders)
+    ->Apply(PoliciesAndAdmission)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_SampledLruAccuracy)
+    ->ArgName("sample_size")->Arg(0)->Arg(1)->Arg(3)->Arg(5)->Arg(10)->Arg(32)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_ParallelHits)
+    ->Apply(ThreadsAndPolicies)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
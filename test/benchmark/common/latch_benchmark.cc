@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <shared_mutex>
+
+#include "common/hybrid_latch.h"
+
+namespace {
+
+/// One latch shared by all benchmark threads, with a word of data it
+/// protects.
+template <typename Latch>
+struct Guarded {
+    Latch latch;
+    uint64_t value = 0;
+};
+
+template <typename Latch>
+Guarded<Latch>& guarded() {
+    static Guarded<Latch> instance;
+    return instance;
+}
+
+/// Acquires and releases the latch exclusively around an increment. With
+/// one thread this is the uncontended cost of a page latch; with more they
+/// all fight over the same latch, like fixes of a hot page in exclusive mode.
+template <typename Latch>
+void BM_Exclusive(benchmark::State& state) {
+    auto& shared = guarded<Latch>();
+    for (auto _ : state) {
+        shared.latch.lock();
+        shared.value++;
+        shared.latch.unlock();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Acquires and releases the latch shared around a read, like fixes of a
+/// hot page in shared mode. Shared holders do not block each other, but
+/// they still write the latch word.
+template <typename Latch>
+void BM_Shared(benchmark::State& state) {
+    auto& shared = guarded<Latch>();
+    for (auto _ : state) {
+        shared.latch.lock_shared();
+        benchmark::DoNotOptimize(shared.value);
+        shared.latch.unlock_shared();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Mostly shared acquires with one exclusive acquire in every `range(0)`,
+/// so shared holders regularly have to wait out a writer.
+template <typename Latch>
+void BM_Mixed(benchmark::State& state) {
+    auto& shared = guarded<Latch>();
+    uint64_t i = 0;
+    for (auto _ : state) {
+        if (++i % state.range(0) == 0) {
+            shared.latch.lock();
+            shared.value++;
+            shared.latch.unlock();
+        } else {
+            shared.latch.lock_shared();
+            benchmark::DoNotOptimize(shared.value);
+            shared.latch.unlock_shared();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Reads under the optimistic latch, which writes no shared memory.
+void BM_Optimistic(benchmark::State& state) {
+    auto& shared = guarded<buzzdb::HybridLatch>();
+    for (auto _ : state) {
+        uint64_t version;
+        while (!shared.latch.try_lock_optimistic(version)) {
+        }
+        benchmark::DoNotOptimize(shared.value);
+        benchmark::DoNotOptimize(shared.latch.validate(version));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Exclusive, std::shared_mutex)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Exclusive, buzzdb::HybridLatch)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Shared, std::shared_mutex)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Shared, buzzdb::HybridLatch)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, std::shared_mutex)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, buzzdb::HybridLatch)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_Optimistic)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
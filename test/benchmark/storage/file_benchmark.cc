@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <system_error>
+#include <vector>
+
+#include "storage/file.h"
+#include "storage/io_uring_file.h"
+
+namespace {
+
+constexpr const char* FILE_NAME = "file_benchmark.dat";
+constexpr size_t BLOCK_SIZE = 4096;
+constexpr size_t BLOCK_COUNT = 16384;  // 64 MiB
+
+/// Block buffers aligned for O_DIRECT.
+struct FreeDeleter {
+    void operator()(char* memory) const {
+        std::free(memory);
+    }
+};
+using AlignedBuffer = std::unique_ptr<char[], FreeDeleter>;
+
+AlignedBuffer allocate_blocks(size_t count) {
+    return AlignedBuffer{static_cast<char*>(
+        std::aligned_alloc(buzzdb::File::DIRECT_IO_ALIGNMENT, count * BLOCK_SIZE))};
+}
+
+/// Reads bypass the page cache, so that the benchmarks measure the device
+/// rather than memcpy out of cached pages.
+buzzdb::File::OpenOptions direct_options() {
+    buzzdb::File::OpenOptions options;
+    options.direct_io = true;
+    return options;
+}
+
+/// Creates the benchmark file once.
+void prepare_file() {
+    static bool prepared = false;
+    if (prepared) {
+        return;
+    }
+    ::unlink(FILE_NAME);
+    auto file = buzzdb::File::open_file(FILE_NAME, buzzdb::File::WRITE);
+    file->resize(BLOCK_SIZE * BLOCK_COUNT);
+    std::vector<char> block(BLOCK_SIZE, 1);
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+        file->write_block(block.data(), i * BLOCK_SIZE, BLOCK_SIZE);
+    }
+    prepared = true;
+}
+
+/// Blocking random 4 KiB reads, i.e. queue depth 1.
+void BM_PosixRandomRead(benchmark::State& state) {
+    prepare_file();
+    std::unique_ptr<buzzdb::File> file;
+    try {
+        file = buzzdb::File::open_file(FILE_NAME, buzzdb::File::READ, direct_options());
+    } catch (const std::system_error&) {
+        state.SkipWithError("O_DIRECT is not supported by this file system");
+        return;
+    }
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<size_t> distr{0, BLOCK_COUNT - 1};
+    AlignedBuffer block = allocate_blocks(1);
+    for (auto _ : state) {
+        file->read_block(distr(engine) * BLOCK_SIZE, BLOCK_SIZE, block.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Random 4 KiB reads that keep `state.range(0)` requests in flight. Every
+/// iteration tops the queue up and reaps at least one completion.
+void BM_AsyncRandomRead(benchmark::State& state) {
+    if (!buzzdb::IoUringFile::is_supported()) {
+        state.SkipWithError("io_uring is not supported");
+        return;
+    }
+    prepare_file();
+    size_t queue_depth = state.range(0);
+    std::unique_ptr<buzzdb::File> file;
+    try {
+        file = buzzdb::File::open_async_file(FILE_NAME, buzzdb::File::READ, direct_options(),
+                                             queue_depth);
+    } catch (const std::system_error&) {
+        state.SkipWithError("O_DIRECT is not supported by this file system");
+        return;
+    }
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<size_t> distr{0, BLOCK_COUNT - 1};
+    AlignedBuffer buffers = allocate_blocks(queue_depth);
+    std::vector<size_t> free_buffers;
+    for (size_t i = 0; i < queue_depth; ++i) {
+        free_buffers.push_back(i);
+    }
+    size_t completed = 0;
+    for (auto _ : state) {
+        while (!free_buffers.empty()) {
+            size_t buffer = free_buffers.back();
+            free_buffers.pop_back();
+            file->read_block_async(distr(engine) * BLOCK_SIZE, BLOCK_SIZE,
+                                   buffers.get() + buffer * BLOCK_SIZE,
+                                   [&free_buffers, &completed, buffer](int) {
+                                       free_buffers.push_back(buffer);
+                                       ++completed;
+                                   });
+        }
+        file->poll(1);
+    }
+    while (file->in_flight() != 0) {
+        file->poll(1);
+    }
+    state.SetItemsProcessed(completed);
+}
+
+}  // namespace
+
+BENCHMARK(BM_PosixRandomRead);
+BENCHMARK(BM_AsyncRandomRead)->ArgName("queue_depth")->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    ::unlink(FILE_NAME);
+    return 0;
+}
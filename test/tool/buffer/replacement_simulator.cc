@@ -0,0 +1,355 @@
+// Replays a recorded page trace through the buffer manager for a sweep of
+// pool sizes and replacement policies and reports how each configuration
+// would have done. Pages are never read or written: segment files are
+// stand-ins that drop all I/O, so only the replacement logic runs.
+//
+// Usage:
+//   replacement_simulator [options] <trace>
+//
+// Options:
+//   --pages=N,M,...      Pool sizes in pages (default 1024,4096,16384).
+//   --policies=P,Q,...   Any of 2q, clock, arc, lru-k, sampled-lru (default
+//                        all).
+//   --lru-k=K            K of LRU-K (default 2).
+//   --sample-size=N      Frames sampled per eviction by sampled LRU
+//                        (default 5).
+//   --admission          Put the TinyLFU admission filter in front.
+//   --threads=N          Configurations replayed in parallel (default: all
+//                        cores).
+//
+// Trace formats:
+//   Text    One reference per line, "r <page_id>" or "w <page_id>". Lines
+//           without a prefix are reads. Lines starting with '#' are skipped.
+//   Binary  Files ending in ".bin" hold one little-endian uint64_t per
+//           reference: the page id, with the top bit set for writes. This
+//           is much faster to replay than text.
+//
+// Every configuration replays the whole trace in its own thread from the
+// memory-mapped file, so a sweep takes about as long as its slowest
+// configuration when enough cores are available.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_manager.h"
+#include "storage/file.h"
+
+namespace {
+
+constexpr uint64_t WRITE_BIT = uint64_t{1} << 63;
+/// The pool never looks at page contents, so keep frames tiny.
+constexpr size_t PAGE_SIZE = 64;
+
+/// Segment file that is not backed by storage. Reads leave the page as it is
+/// and writes are dropped.
+class NullFile : public buzzdb::File {
+public:
+    Mode get_mode() const override {
+        return WRITE;
+    }
+
+    size_t size() const override {
+        return SIZE_MAX;
+    }
+
+    void resize(size_t) override {}
+
+    void read_block(size_t, size_t, char*) override {}
+
+    void write_block(const char*, size_t, size_t) override {}
+};
+
+/// A read-only mapping of the trace file.
+class Trace {
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+
+public:
+    explicit Trace(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            std::perror(path);
+            std::exit(1);
+        }
+        length = st.st_size;
+        if (length > 0) {
+            void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                std::perror("mmap");
+                std::exit(1);
+            }
+            ::madvise(mapping, length, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+    }
+
+    ~Trace() {
+        if (data != nullptr) {
+            ::munmap(const_cast<char*>(data), length);
+        }
+    }
+
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+
+    /// Calls `fn(page_id, is_write)` for every reference in the binary format.
+    template <typename Fn>
+    void for_each_binary(Fn&& fn) const {
+        size_t count = length / sizeof(uint64_t);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t entry;
+            std::memcpy(&entry, data + i * sizeof(uint64_t), sizeof(entry));
+            fn(entry & ~WRITE_BIT, (entry & WRITE_BIT) != 0);
+        }
+    }
+
+    /// Calls `fn(page_id, is_write)` for every reference in the text format.
+    template <typename Fn>
+    void for_each_text(Fn&& fn) const {
+        const char* pos = data;
+        const char* end = data + length;
+        while (pos < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            while (pos < lineEnd && (*pos == ' ' || *pos == '\t')) {
+                pos++;
+            }
+            bool isWrite = false;
+            if (pos < lineEnd && (*pos == 'r' || *pos == 'w')) {
+                isWrite = *pos == 'w';
+                pos++;
+                while (pos < lineEnd && (*pos == ' ' || *pos == '\t')) {
+                    pos++;
+                }
+            }
+            if (pos < lineEnd && *pos >= '0' && *pos <= '9') {
+                uint64_t pageId = 0;
+                while (pos < lineEnd && *pos >= '0' && *pos <= '9') {
+                    pageId = pageId * 10 + (*pos - '0');
+                    pos++;
+                }
+                fn(pageId, isWrite);
+            }
+            pos = lineEnd + 1;
+        }
+    }
+};
+
+struct Config {
+    buzzdb::ReplacementPolicyType policy;
+    const char* policyName;
+    size_t pages;
+};
+
+struct Result {
+    uint64_t references = 0;
+    buzzdb::BufferManagerStats stats;
+    double seconds = 0;
+    bool bufferFull = false;
+};
+
+Result replay(const Trace& trace, bool binary, const Config& config,
+              const buzzdb::BufferManagerOptions& baseOptions) {
+    buzzdb::BufferManagerOptions options = baseOptions;
+    options.replacement_policy = config.policy;
+    buzzdb::BufferManager bufferManager{PAGE_SIZE, config.pages, options};
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    auto fix = [&](uint64_t page_id, bool is_write) {
+        auto& page = bufferManager.fix_page(page_id, is_write);
+        bufferManager.unfix_page(page, is_write);
+        result.references++;
+    };
+    try {
+        if (binary) {
+            trace.for_each_binary(fix);
+        } else {
+            trace.for_each_text(fix);
+        }
+    } catch (const buzzdb::buffer_full_error&) {
+        result.bufferFull = true;
+    }
+    result.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    // Taken before the destructor flushes the remaining dirty pages.
+    result.stats = bufferManager.get_stats();
+    return result;
+}
+
+bool parsePolicy(const std::string& name, buzzdb::ReplacementPolicyType& policy) {
+    if (name == "2q") {
+        policy = buzzdb::ReplacementPolicyType::TWO_QUEUE;
+    } else if (name == "clock") {
+        policy = buzzdb::ReplacementPolicyType::CLOCK;
+    } else if (name == "arc") {
+        policy = buzzdb::ReplacementPolicyType::ARC;
+    } else if (name == "lru-k") {
+        policy = buzzdb::ReplacementPolicyType::LRU_K;
+    } else if (name == "sampled-lru") {
+        policy = buzzdb::ReplacementPolicyType::SAMPLED_LRU;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Parses a positive decimal number. Returns false for anything else.
+bool parseCount(const std::string& text, size_t& count) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    errno = 0;
+    unsigned long long value = std::strtoull(text.c_str(), nullptr, 10);
+    if (errno != 0 || value == 0) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) {
+            comma = list.size();
+        }
+        if (comma > start) {
+            items.push_back(list.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return items;
+}
+
+[[noreturn]] void usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--pages=N,...] [--policies=2q,clock,arc,lru-k,sampled-lru]\n"
+                 "       [--lru-k=K] [--sample-size=N] [--admission] [--threads=N] <trace>\n",
+                 program);
+    std::exit(2);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> poolSizes{1024, 4096, 16384};
+    std::vector<std::string> policyNames{"2q", "clock", "arc", "lru-k", "sampled-lru"};
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    const char* tracePath = nullptr;
+
+    buzzdb::BufferManagerOptions options;
+    options.sync_each_write = false;
+    options.file_opener = [](uint16_t) { return std::make_unique<NullFile>(); };
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? argv[i] + length : nullptr;
+        };
+        size_t count;
+        if (const char* list = value("--pages=")) {
+            poolSizes.clear();
+            for (auto& item : splitList(list)) {
+                if (!parseCount(item, count)) {
+                    usage(argv[0]);
+                }
+                poolSizes.push_back(count);
+            }
+        } else if (const char* list = value("--policies=")) {
+            policyNames = splitList(list);
+        } else if (const char* k = value("--lru-k=")) {
+            if (!parseCount(k, count)) {
+                usage(argv[0]);
+            }
+            options.lru_k = count;
+        } else if (const char* size = value("--sample-size=")) {
+            if (!parseCount(size, count)) {
+                usage(argv[0]);
+            }
+            options.sampled_lru_sample_size = count;
+        } else if (const char* threads = value("--threads=")) {
+            if (!parseCount(threads, count)) {
+                usage(argv[0]);
+            }
+            threadCount = count;
+        } else if (arg == "--admission") {
+            options.admission_filter = true;
+        } else if (arg[0] == '-' || tracePath != nullptr) {
+            usage(argv[0]);
+        } else {
+            tracePath = argv[i];
+        }
+    }
+    if (tracePath == nullptr || poolSizes.empty() || policyNames.empty()) {
+        usage(argv[0]);
+    }
+
+    std::vector<Config> configs;
+    for (auto& name : policyNames) {
+        buzzdb::ReplacementPolicyType policy;
+        if (!parsePolicy(name, policy)) {
+            std::fprintf(stderr, "unknown policy: %s\n", name.c_str());
+            usage(argv[0]);
+        }
+        for (size_t pages : poolSizes) {
+            configs.push_back({policy, name.c_str(), pages});
+        }
+    }
+
+    Trace trace{tracePath};
+    std::string path = tracePath;
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+
+    std::vector<Result> results(configs.size());
+    std::atomic<size_t> nextConfig{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min(threadCount, configs.size()); t++) {
+        threads.emplace_back([&] {
+            for (size_t i = nextConfig++; i < configs.size(); i = nextConfig++) {
+                results[i] = replay(trace, binary, configs[i], options);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::printf("%-12s %10s %14s %10s %14s %14s %10s\n", "policy", "pages", "references",
+                "hit_ratio", "evictions", "writebacks", "seconds");
+    for (size_t i = 0; i < configs.size(); i++) {
+        const Result& result = results[i];
+        const auto& stats = result.stats;
+        double hitRatio = result.references == 0
+            ? 0.0 : 1.0 - static_cast<double>(stats.misses) / result.references;
+        uint64_t evictions = stats.foreground_writebacks + stats.writebacks_avoided;
+        std::printf("%-12s %10zu %14lu %10.4f %14lu %14lu %10.2f%s\n", configs[i].policyName,
+                    configs[i].pages, static_cast<unsigned long>(result.references), hitRatio,
+                    static_cast<unsigned long>(evictions),
+                    static_cast<unsigned long>(stats.writebacks), result.seconds,
+                    result.bufferFull ? "  (stopped: buffer full)" : "");
+    }
+    return 0;
+}
@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstring>
 #include <memory>
 #include <random>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -56,6 +58,28 @@ TEST(BufferManagerTest, PersistentRestart) {
   }
 }
 
+TEST(BufferManagerTest, DirectIoRestart) {
+  buzzdb::BufferManagerOptions options;
+  options.direct_io = true;
+  EXPECT_THROW((buzzdb::BufferManager{1024, 10, options}),
+               std::invalid_argument);
+  uint64_t segment_shift = static_cast<uint64_t>(9) << 48;
+  auto buffer_manager =
+      std::make_unique<buzzdb::BufferManager>(4096, 4, options);
+  for (uint64_t segment_page = 0; segment_page < 8; ++segment_page) {
+    auto& page = buffer_manager->fix_page(segment_shift | segment_page, true);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page.get_data()) % 4096);
+    *reinterpret_cast<uint64_t*>(page.get_data()) = segment_page + 1;
+    buffer_manager->unfix_page(page, true);
+  }
+  buffer_manager = std::make_unique<buzzdb::BufferManager>(4096, 4, options);
+  for (uint64_t segment_page = 0; segment_page < 8; ++segment_page) {
+    auto& page = buffer_manager->fix_page(segment_shift | segment_page, false);
+    EXPECT_EQ(segment_page + 1, *reinterpret_cast<uint64_t*>(page.get_data()));
+    buffer_manager->unfix_page(page, false);
+  }
+}
+
 TEST(BufferManagerTest, FIFOEvict) {
   buzzdb::BufferManager buffer_manager{1024, 10};
   for (uint64_t i = 1; i < 11; ++i) {
@@ -78,6 +102,176 @@ TEST(BufferManagerTest, FIFOEvict) {
   }
 }
 
+TEST(BufferManagerTest, RecycledFrameIsReloaded) {
+  buzzdb::BufferManager buffer_manager{1024, 1};
+  uint64_t written_page = (static_cast<uint64_t>(5) << 48) | 1;
+  {
+    auto& page = buffer_manager.fix_page(written_page, true);
+    std::memset(page.get_data(), 0xAB, 1024);
+    buffer_manager.unfix_page(page, true);
+  }
+  // The only frame is recycled for a page that does not exist on disk yet,
+  // so it must not keep the bytes of the evicted page.
+  uint64_t new_page = (static_cast<uint64_t>(6) << 48) | 100;
+  auto& page = buffer_manager.fix_page(new_page, false);
+  std::vector<char> expected(1024, 0);
+  EXPECT_EQ(0, std::memcmp(expected.data(), page.get_data(), 1024));
+  buffer_manager.unfix_page(page, false);
+}
+
+TEST(BufferManagerTest, CleanEvictionSkipsWriteback) {
+  buzzdb::BufferManager buffer_manager{1024, 2};
+  uint64_t segment_shift = static_cast<uint64_t>(7) << 48;
+  {
+    auto& page = buffer_manager.fix_page(segment_shift | 1, true);
+    std::memset(page.get_data(), 0x5A, 1024);
+    buffer_manager.unfix_page(page, true);
+  }
+  {
+    // A clean unfix must not wipe out the earlier dirty one.
+    auto& page = buffer_manager.fix_page(segment_shift | 1, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  {
+    auto& page = buffer_manager.fix_page(segment_shift | 2, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  // Evicts the clean FIFO page 2, then, once page 3 is in the LRU list too,
+  // the dirty page 1.
+  for (uint64_t segment_page : {3, 3, 4}) {
+    auto& page = buffer_manager.fix_page(segment_shift | segment_page, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  auto stats = buffer_manager.get_stats();
+  EXPECT_EQ(1, stats.writebacks);
+  EXPECT_EQ(1, stats.writebacks_avoided);
+  auto& page = buffer_manager.fix_page(segment_shift | 1, false);
+  std::vector<char> expected(1024, 0x5A);
+  EXPECT_EQ(0, std::memcmp(expected.data(), page.get_data(), 1024));
+  buffer_manager.unfix_page(page, false);
+}
+
+TEST(BufferManagerTest, BackgroundWriterCleansPages) {
+  buzzdb::BufferManagerOptions options;
+  options.background_writer = true;
+  options.background_writer_dirty_ratio = 0.5;
+  options.background_writer_interval = std::chrono::milliseconds{1};
+  buzzdb::BufferManager buffer_manager{1024, 10, options};
+  uint64_t segment_shift = static_cast<uint64_t>(8) << 48;
+  for (uint64_t segment_page = 0; segment_page < 10; ++segment_page) {
+    auto& page = buffer_manager.fix_page(segment_shift | segment_page, true);
+    std::memset(page.get_data(), static_cast<int>(segment_page), 1024);
+    buffer_manager.unfix_page(page, true);
+  }
+  // The writer brings the dirty ratio down to half of the threshold.
+  for (size_t i = 0; i < 5000; ++i) {
+    if (buffer_manager.get_stats().background_writebacks >= 6) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  auto stats = buffer_manager.get_stats();
+  EXPECT_GE(stats.background_writebacks, 6);
+  // The oldest pages were written first, so evicting them is free.
+  auto& page = buffer_manager.fix_page(segment_shift | 10, false);
+  buffer_manager.unfix_page(page, false);
+  EXPECT_EQ(1, buffer_manager.get_stats().writebacks_avoided);
+}
+
+TEST(BufferManagerTest, BackgroundWriterReachesLowMarkAcrossPartitions) {
+  buzzdb::BufferManagerOptions options;
+  options.partition_count = 4;
+  options.background_writer = true;
+  options.background_writer_dirty_ratio = 0.5;
+  options.background_writer_interval = std::chrono::milliseconds{1};
+  buzzdb::BufferManager buffer_manager{1024, 160, options};
+  for (uint64_t page_id = 0; page_id < 80; ++page_id) {
+    auto& page = buffer_manager.fix_page(page_id, true);
+    buffer_manager.unfix_page(page, true);
+  }
+  // No partition holds enough dirty pages to get from the high mark of 80
+  // down to the low mark of 40 on its own.
+  for (size_t i = 0; i < 5000; ++i) {
+    if (buffer_manager.get_stats().background_writebacks >= 40) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  EXPECT_GE(buffer_manager.get_stats().background_writebacks, 40);
+}
+
+TEST(BufferManagerTest, CleanVictimWindowSkipsDirtyPages) {
+  buzzdb::BufferManagerOptions options;
+  options.clean_victim_window = 4;
+  buzzdb::BufferManager buffer_manager{1024, 10, options};
+  for (uint64_t page_id = 0; page_id < 10; ++page_id) {
+    bool dirty = page_id < 2;
+    auto& page = buffer_manager.fix_page(page_id, dirty);
+    buffer_manager.unfix_page(page, dirty);
+  }
+  // Pages 0 and 1 are dirty, so page 2 is evicted and the others are
+  // written in the background.
+  auto& page = buffer_manager.fix_page(10, false);
+  buffer_manager.unfix_page(page, false);
+  auto stats = buffer_manager.get_stats();
+  EXPECT_EQ(2, stats.dirty_victims_skipped);
+  EXPECT_EQ(0, stats.foreground_writebacks);
+  EXPECT_EQ(1, stats.writebacks_avoided);
+  for (size_t i = 0; i < 5000; ++i) {
+    if (buffer_manager.get_stats().background_writebacks == 2) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  EXPECT_EQ(2, buffer_manager.get_stats().background_writebacks);
+  // Page 0 is clean now and can go without a write.
+  auto& other_page = buffer_manager.fix_page(11, false);
+  buffer_manager.unfix_page(other_page, false);
+  stats = buffer_manager.get_stats();
+  EXPECT_EQ(2, stats.writebacks_avoided);
+  EXPECT_EQ(0, stats.foreground_writebacks);
+  EXPECT_EQ(2, stats.dirty_victims_skipped);
+}
+
+TEST(BufferManagerTest, CleanVictimWindowCountsRevisitedPagesOnce) {
+  buzzdb::BufferManagerOptions options;
+  options.replacement_policy = buzzdb::ReplacementPolicyType::CLOCK;
+  options.clean_victim_window = 4;
+  buzzdb::BufferManager buffer_manager{1024, 3, options};
+  for (uint64_t page_id = 0; page_id < 3; ++page_id) {
+    auto& page = buffer_manager.fix_page(page_id, true);
+    buffer_manager.unfix_page(page, true);
+  }
+  // The hand comes back to page 0 before it finds a clean page, so page 0
+  // is evicted and only pages 1 and 2 are left to the background writer.
+  auto& page = buffer_manager.fix_page(3, false);
+  buffer_manager.unfix_page(page, false);
+  auto stats = buffer_manager.get_stats();
+  EXPECT_EQ(2, stats.dirty_victims_skipped);
+  EXPECT_EQ(1, stats.foreground_writebacks);
+  EXPECT_EQ((std::vector<uint64_t>{1, 2, 3}), buffer_manager.get_fifo_list());
+}
+
+TEST(BufferManagerTest, CleanVictimWindowIgnoresCorrelatedPages) {
+  buzzdb::BufferManagerOptions options;
+  options.replacement_policy = buzzdb::ReplacementPolicyType::LRU_K;
+  options.lru_k_correlated_period = 3;
+  options.clean_victim_window = 2;
+  buzzdb::BufferManager buffer_manager{1024, 5, options};
+  for (uint64_t page_id = 0; page_id < 5; ++page_id) {
+    auto& page = buffer_manager.fix_page(page_id, true);
+    buffer_manager.unfix_page(page, true);
+  }
+  // Only page 0 is outside its correlated period. After it is skipped, the
+  // correlated pages are offered in order and page 1 fills the window.
+  auto& page = buffer_manager.fix_page(5, false);
+  buffer_manager.unfix_page(page, false);
+  auto stats = buffer_manager.get_stats();
+  EXPECT_EQ(1, stats.dirty_victims_skipped);
+  EXPECT_EQ(1, stats.foreground_writebacks);
+  EXPECT_EQ((std::vector<uint64_t>{0, 2, 3, 4, 5}), buffer_manager.get_fifo_list());
+}
+
 TEST(BufferManagerTest, BufferFull) {
   buzzdb::BufferManager buffer_manager{1024, 10};
   std::vector<buzzdb::BufferFrame*> pages;
@@ -226,6 +420,514 @@ TEST(BufferManagerTest, MultithreadManyPages) {
   }
 }
 
+TEST(BufferManagerTest, PartitionedParallelFix) {
+  buzzdb::BufferManagerOptions options;
+  options.partition_count = 4;
+  EXPECT_THROW((buzzdb::BufferManager{1024, 3, options}),
+               std::invalid_argument);
+  buzzdb::BufferManager buffer_manager{1024, 64, options};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([i, &buffer_manager] {
+      for (uint64_t j = 0; j < 8; ++j) {
+        auto& page = buffer_manager.fix_page(i * 8 + j, true);
+        *reinterpret_cast<uint64_t*>(page.get_data()) = i * 8 + j;
+        buffer_manager.unfix_page(page, true);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto fifo_list = buffer_manager.get_fifo_list();
+  std::sort(fifo_list.begin(), fifo_list.end());
+  EXPECT_EQ(32, fifo_list.size());
+  for (uint64_t page_id = 0; page_id < 32; ++page_id) {
+    EXPECT_EQ(page_id, fifo_list[page_id]);
+    auto& page = buffer_manager.fix_page(page_id, false);
+    EXPECT_EQ(page_id, *reinterpret_cast<uint64_t*>(page.get_data()));
+    buffer_manager.unfix_page(page, false);
+  }
+  EXPECT_EQ(32, buffer_manager.get_lru_list().size());
+}
+
+TEST(BufferManagerTest, ClockGivesSecondChance) {
+  buzzdb::BufferManagerOptions options;
+  options.replacement_policy = buzzdb::ReplacementPolicyType::CLOCK;
+  buzzdb::BufferManager buffer_manager{1024, 3, options};
+  for (uint64_t page_id : {0, 1, 2, 0}) {
+    auto& page = buffer_manager.fix_page(page_id, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  // The hand clears the reference bit of page 0 and evicts page 1.
+  {
+    auto& page = buffer_manager.fix_page(3, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  EXPECT_EQ((std::vector<uint64_t>{2, 0, 3}), buffer_manager.get_fifo_list());
+  // Page 0 has used up its second chance, so page 2 goes next.
+  {
+    auto& page = buffer_manager.fix_page(4, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  EXPECT_EQ((std::vector<uint64_t>{0, 3, 4}), buffer_manager.get_fifo_list());
+  EXPECT_TRUE(buffer_manager.get_lru_list().empty());
+}
+
+TEST(BufferManagerTest, ArcPromotesGhostHits) {
+  buzzdb::BufferManagerOptions options;
+  options.replacement_policy = buzzdb::ReplacementPolicyType::ARC;
+  buzzdb::BufferManager buffer_manager{1024, 4, options};
+  for (uint64_t page_id : {0, 1, 0, 1, 2, 3, 4}) {
+    auto& page = buffer_manager.fix_page(page_id, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  // Page 2 was evicted from T1 and is remembered in the ghost list B1.
+  EXPECT_EQ((std::vector<uint64_t>{3, 4}), buffer_manager.get_fifo_list());
+  EXPECT_EQ((std::vector<uint64_t>{0, 1}), buffer_manager.get_lru_list());
+  // Fixing page 2 again is a miss, but it goes straight into T2 and grows
+  // the target size of T1 to one page, so T1 gives up page 3.
+  {
+    auto& page = buffer_manager.fix_page(2, false);
+    buffer_manager.unfix_page(page, false);
+  }
+  EXPECT_EQ(std::vector<uint64_t>{4}, buffer_manager.get_fifo_list());
+  EXPECT_EQ((std::vector<uint64_t>{0, 1, 2}), buffer_manager.get_lru_list());
+  EXPECT_EQ(6, buffer_manager.get_stats().misses);
+}
+
+TEST(BufferManagerTest, LruKKeepsPagesWithHistory) {
+  buzzdb::BufferManagerOptions options;
+  options.replacement_policy = buzzdb::ReplacementPolicyType::LRU_K;
+  EXPECT_EQ(2, options.lru_k);
+  {
+    buzzdb::BufferManager buffer_manager{1024, 3, options};
+    for (uint64_t page_id : {0, 0, 1, 2, 3, 4}) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    // Pages 1 and 2 were only accessed once, so they went before page 0
+    // even though page 0 is the least recently used page.
+    EXPECT_EQ((std::vector<uint64_t>{3, 4}), buffer_manager.get_fifo_list());
+    EXPECT_EQ(std::vector<uint64_t>{0}, buffer_manager.get_lru_list());
+  }
+  // Within the correlated period, the second access to page 0 is part of
+  // the first reference.
+  options.lru_k_correlated_period = 4;
+  {
+    buzzdb::BufferManager buffer_manager{1024, 3, options};
+    for (uint64_t page_id : {0, 0, 1, 2, 3, 4}) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    EXPECT_EQ((std::vector<uint64_t>{2, 3, 4}), buffer_manager.get_fifo_list());
+    EXPECT_TRUE(buffer_manager.get_lru_list().empty());
+  }
+  // A victim that is the last frame of the heap keeps its history too. The
+  // pinned page 1 sits at the root, so page 0 is taken from the end.
+  options.lru_k_correlated_period = 0;
+  {
+    buzzdb::BufferManager buffer_manager{1024, 2, options};
+    for (uint64_t page_id : {0, 0}) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    auto& pinned = buffer_manager.fix_page(1, false);
+    {
+      auto& page = buffer_manager.fix_page(2, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    buffer_manager.unfix_page(pinned, false);
+    {
+      auto& page = buffer_manager.fix_page(0, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    EXPECT_EQ(std::vector<uint64_t>{2}, buffer_manager.get_fifo_list());
+    EXPECT_EQ(std::vector<uint64_t>{0}, buffer_manager.get_lru_list());
+  }
+  // Pages with fewer than K accesses go by their first access, so page 0
+  // goes before page 1 even though it was used more recently.
+  options.lru_k = 3;
+  {
+    buzzdb::BufferManager buffer_manager{1024, 3, options};
+    for (uint64_t page_id : {0, 1, 0, 2, 3}) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    EXPECT_EQ((std::vector<uint64_t>{1, 2, 3}), buffer_manager.get_fifo_list());
+  }
+  options.lru_k = 0;
+  EXPECT_THROW((buzzdb::BufferManager{1024, 3, options}), std::invalid_argument);
+}
+
+TEST(BufferManagerTest, SampledLruEvictsOldestSampledPage) {
+  buzzdb::BufferManagerOptions options;
+  options.replacement_policy = buzzdb::ReplacementPolicyType::SAMPLED_LRU;
+  // Large enough that every sample practically covers all four frames.
+  options.sampled_lru_sample_size = 64;
+  {
+    buzzdb::BufferManager buffer_manager{1024, 4, options};
+    for (uint64_t page_id : {0, 1, 2, 3, 0, 4}) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(page, false);
+    }
+    EXPECT_EQ((std::vector<uint64_t>{2, 0, 3, 4}), buffer_manager.get_fifo_list());
+  }
+  {
+    // Fixed pages are skipped even when they are the oldest.
+    buzzdb::BufferManager buffer_manager{1024, 2, options};
+    auto& page = buffer_manager.fix_page(0, false);
+    for (uint64_t page_id : {1, 2}) {
+      auto& other_page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(other_page, false);
+    }
+    buffer_manager.unfix_page(page, false);
+    EXPECT_EQ((std::vector<uint64_t>{0, 2}), buffer_manager.get_fifo_list());
+  }
+  {
+    // Each sampled frame is offered to the clean victim window once, oldest
+    // first, even though the sample draws it many times.
+    options.clean_victim_window = 3;
+    buzzdb::BufferManager buffer_manager{1024, 4, options};
+    for (uint64_t page_id : {0, 1, 2, 3}) {
+      bool dirty = page_id < 2;
+      auto& page = buffer_manager.fix_page(page_id, dirty);
+      buffer_manager.unfix_page(page, dirty);
+    }
+    auto& page = buffer_manager.fix_page(4, false);
+    buffer_manager.unfix_page(page, false);
+    EXPECT_EQ((std::vector<uint64_t>{0, 1, 3, 4}), buffer_manager.get_fifo_list());
+    EXPECT_EQ(2, buffer_manager.get_stats().dirty_victims_skipped);
+    options.clean_victim_window = 0;
+  }
+  options.sampled_lru_sample_size = 0;
+  EXPECT_THROW((buzzdb::BufferManager{1024, 4, options}), std::invalid_argument);
+}
+
+TEST(BufferManagerTest, AdmissionFilterProtectsHotPages) {
+  buzzdb::BufferManagerOptions options;
+  options.admission_filter = true;
+  buzzdb::BufferManager buffer_manager{1024, 4, options};
+  auto access = [&](uint64_t page_id) {
+    auto& page = buffer_manager.fix_page(page_id, false);
+    buffer_manager.unfix_page(page, false);
+  };
+  for (size_t i = 0; i < 4; ++i) {
+    for (uint64_t page_id : {0, 1, 2}) {
+      access(page_id);
+    }
+  }
+  // A scan of pages that are read once only cycles through the probation
+  // ring and the policy's first victim.
+  for (uint64_t page_id = 100; page_id < 120; ++page_id) {
+    access(page_id);
+  }
+  EXPECT_TRUE(buffer_manager.get_fifo_list().empty());
+  EXPECT_EQ((std::vector<uint64_t>{0, 1, 2}), buffer_manager.get_lru_list());
+  // Page 100 still found a free frame.
+  EXPECT_EQ(19, buffer_manager.get_stats().admissions_rejected);
+
+  // A page on probation that is used often is admitted once it is the
+  // oldest page on probation and more popular than the policy's victim.
+  for (size_t i = 0; i < 8; ++i) {
+    access(200);
+  }
+  access(201);
+  EXPECT_EQ(std::vector<uint64_t>{200}, buffer_manager.get_fifo_list());
+  EXPECT_EQ((std::vector<uint64_t>{1, 2}), buffer_manager.get_lru_list());
+}
+
+TEST(BufferManagerTest, ScanStrategyKeepsWorkingSet) {
+  buzzdb::BufferManager buffer_manager{1024, 8};
+  for (size_t i = 0; i < 2; ++i) {
+    for (uint64_t page_id : {0, 1, 2, 3}) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      buffer_manager.unfix_page(page, false);
+    }
+  }
+  {
+    buzzdb::ScanStrategy scan{buffer_manager, 2};
+    for (uint64_t page_id = 100; page_id < 200; ++page_id) {
+      auto& page = buffer_manager.fix_page(page_id, true, scan);
+      *reinterpret_cast<uint64_t*>(page.get_data()) = page_id;
+      buffer_manager.unfix_page(page, true);
+    }
+    // Resident pages are used in place.
+    auto& page = buffer_manager.fix_page(0, false, scan);
+    buffer_manager.unfix_page(page, false);
+    EXPECT_TRUE(buffer_manager.get_fifo_list().empty());
+  }
+  // The scan only used its two ring frames, which join the pool now.
+  EXPECT_EQ((std::vector<uint64_t>{198, 199}), buffer_manager.get_fifo_list());
+  EXPECT_EQ((std::vector<uint64_t>{1, 2, 3, 0}), buffer_manager.get_lru_list());
+  EXPECT_EQ(104, buffer_manager.get_stats().misses);
+  EXPECT_EQ(98, buffer_manager.get_stats().writebacks);
+  auto& page = buffer_manager.fix_page(100, false);
+  EXPECT_EQ(100, *reinterpret_cast<uint64_t*>(page.get_data()));
+  buffer_manager.unfix_page(page, false);
+}
+
+TEST(BufferManagerTest, FlushAllWithoutSyncedWrites) {
+  buzzdb::BufferManagerOptions options;
+  options.sync_each_write = false;
+  {
+    buzzdb::BufferManager buffer_manager{1024, 10, options};
+    for (uint64_t page_id = 0; page_id < 4; ++page_id) {
+      auto& page = buffer_manager.fix_page(page_id, true);
+      *reinterpret_cast<uint64_t*>(page.get_data()) = page_id + 100;
+      buffer_manager.unfix_page(page, true);
+    }
+    buffer_manager.flush_all();
+    EXPECT_EQ(4, buffer_manager.get_stats().writebacks);
+    // Everything is clean now, so a second flush writes nothing.
+    buffer_manager.flush_all();
+    EXPECT_EQ(4, buffer_manager.get_stats().writebacks);
+  }
+  {
+    buzzdb::BufferManager buffer_manager{1024, 10, options};
+    for (uint64_t page_id = 0; page_id < 4; ++page_id) {
+      auto& page = buffer_manager.fix_page(page_id, false);
+      EXPECT_EQ(page_id + 100, *reinterpret_cast<uint64_t*>(page.get_data()));
+      buffer_manager.unfix_page(page, false);
+    }
+  }
+}
+
+TEST(BufferManagerTest, CoolingRescuesReusedPages) {
+  buzzdb::BufferManagerOptions options;
+  options.cooling_ratio = 0.2;
+  options.free_frames_ratio = 0.2;
+  buzzdb::BufferManager buffer_manager{1024, 10, options};
+  auto fix = [&](uint64_t page_id) {
+    auto& page = buffer_manager.fix_page(page_id, false);
+    buffer_manager.unfix_page(page, false);
+  };
+  for (uint64_t page_id = 0; page_id < 10; ++page_id) {
+    fix(page_id);
+  }
+  // Frees pages 0 and 1, and moves 2 and 3 to the cooling stage.
+  fix(10);
+  fix(2);
+  // Takes the second free frame.
+  fix(11);
+  // Page 2 was used while cooling and is rescued. Pages 3 and 4 are freed.
+  fix(12);
+  EXPECT_EQ(1, buffer_manager.get_stats().cooling_rescues);
+  EXPECT_EQ(13, buffer_manager.get_stats().misses);
+  fix(2);
+  fix(5);
+  EXPECT_EQ(13, buffer_manager.get_stats().misses);
+  fix(3);
+  EXPECT_EQ(14, buffer_manager.get_stats().misses);
+}
+
+TEST(BufferManagerTest, SegmentQuotas) {
+  buzzdb::BufferManagerOptions options;
+  options.segment_quotas[1].min_frames = 3;
+  options.segment_quotas[2].max_frames = 4;
+  buzzdb::BufferManager buffer_manager{1024, 10, options};
+  auto fix = [&](uint64_t segment_id, uint64_t segment_page) {
+    auto& page = buffer_manager.fix_page((segment_id << 48) | segment_page, false);
+    buffer_manager.unfix_page(page, false);
+  };
+  for (uint64_t segment_page = 0; segment_page < 3; ++segment_page) {
+    fix(1, segment_page);
+  }
+  // The scan of segment 0 cannot evict the reserved pages of segment 1.
+  for (uint64_t segment_page = 0; segment_page < 20; ++segment_page) {
+    fix(0, segment_page);
+  }
+  EXPECT_EQ(3, buffer_manager.get_segment_residency(1));
+  EXPECT_EQ(7, buffer_manager.get_segment_residency(0));
+  // Segment 2 replaces its own pages once it holds four frames.
+  for (uint64_t segment_page = 0; segment_page < 10; ++segment_page) {
+    fix(2, segment_page);
+  }
+  EXPECT_EQ(4, buffer_manager.get_segment_residency(2));
+  EXPECT_EQ(3, buffer_manager.get_segment_residency(1));
+  EXPECT_EQ(3, buffer_manager.get_segment_residency(0));
+  // Pages 6 to 9 of segment 2 are resident.
+  uint64_t misses = buffer_manager.get_stats().misses;
+  fix(2, 9);
+  fix(2, 6);
+  EXPECT_EQ(misses, buffer_manager.get_stats().misses);
+
+  options.segment_quotas[2].min_frames = 5;
+  EXPECT_THROW((buzzdb::BufferManager{1024, 10, options}), std::invalid_argument);
+  options.segment_quotas[2].max_frames = 7;
+  options.segment_quotas[2].min_frames = 7;
+  EXPECT_THROW((buzzdb::BufferManager{1024, 10, options}), std::invalid_argument);
+}
+
+TEST(BufferManagerTest, OptimisticReads) {
+  buzzdb::BufferManager buffer_manager{1024, 2};
+  {
+    auto& page = buffer_manager.fix_page(1, true);
+    *reinterpret_cast<uint64_t*>(page.get_data()) = 42;
+    buffer_manager.unfix_page(page, true);
+  }
+  uint64_t version;
+  EXPECT_EQ(nullptr, buffer_manager.fix_page_optimistic(2, version));
+  auto* frame = buffer_manager.fix_page_optimistic(1, version);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(42, *reinterpret_cast<uint64_t*>(frame->get_data()));
+  EXPECT_TRUE(buzzdb::BufferManager::validate_page(*frame, version));
+
+  // A writer invalidates the read and keeps new readers away.
+  auto& page = buffer_manager.fix_page(1, true);
+  EXPECT_FALSE(buzzdb::BufferManager::validate_page(*frame, version));
+  uint64_t other_version;
+  EXPECT_EQ(nullptr, buffer_manager.fix_page_optimistic(1, other_version));
+  buffer_manager.unfix_page(page, false);
+  frame = buffer_manager.fix_page_optimistic(1, version);
+  ASSERT_NE(nullptr, frame);
+
+  // So does the eviction of the page. With page 2 fixed, page 3 can only
+  // take the frame of page 1.
+  auto& fixed_page = buffer_manager.fix_page(2, false);
+  auto& other_page = buffer_manager.fix_page(3, false);
+  buffer_manager.unfix_page(other_page, false);
+  buffer_manager.unfix_page(fixed_page, false);
+  EXPECT_FALSE(buzzdb::BufferManager::validate_page(*frame, version));
+  auto value = buffer_manager.read_page(1, [](const char* data) {
+    return *reinterpret_cast<const uint64_t*>(data);
+  });
+  EXPECT_EQ(42, value);
+}
+
+TEST(BufferManagerTest, OptimisticReadsSeeConsistentPages) {
+  buzzdb::BufferManager buffer_manager{1024, 4};
+  {
+    auto& page = buffer_manager.fix_page(0, true);
+    std::memset(page.get_data(), 0, 1024);
+    buffer_manager.unfix_page(page, true);
+  }
+  // The writer keeps both words of the page equal.
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (uint64_t i = 1; i <= 20000; ++i) {
+      auto& page = buffer_manager.fix_page(0, true);
+      auto* words = reinterpret_cast<uint64_t*>(page.get_data());
+      words[0] = i;
+      words[1] = i;
+      buffer_manager.unfix_page(page, true);
+    }
+    done = true;
+  });
+  size_t torn = 0;
+  while (!done) {
+    torn += buffer_manager.read_page(0, [](const char* data) {
+      auto* words = reinterpret_cast<const volatile uint64_t*>(data);
+      return words[0] != words[1];
+    });
+  }
+  writer.join();
+  EXPECT_EQ(0, torn);
+}
+
+TEST(BufferManagerTest, ConcurrentMissesShareOneRead) {
+  // Segment file whose reads are slow, counted and can be made to fail.
+  struct SlowFile : buzzdb::File {
+    std::atomic<size_t>& reads;
+    std::atomic<bool>& fail;
+    SlowFile(std::atomic<size_t>& reads, std::atomic<bool>& fail)
+        : reads(reads), fail(fail) {}
+    Mode get_mode() const override { return WRITE; }
+    size_t size() const override { return SIZE_MAX; }
+    void resize(size_t) override {}
+    void read_block(size_t, size_t size, char* block) override {
+      ++reads;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      if (fail) {
+        throw std::runtime_error{"read failed"};
+      }
+      std::memset(block, 42, size);
+    }
+    void write_block(const char*, size_t, size_t) override {}
+  };
+  std::atomic<size_t> reads{0};
+  std::atomic<bool> fail{false};
+  buzzdb::BufferManagerOptions options;
+  options.file_opener = [&](uint16_t) {
+    return std::make_unique<SlowFile>(reads, fail);
+  };
+  buzzdb::BufferManager buffer_manager{1024, 10, options};
+
+  // The first fix reads the page; the others wait for that read.
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 3; ++i) {
+    threads.emplace_back([&buffer_manager] {
+      auto& page = buffer_manager.fix_page(1, false);
+      EXPECT_EQ(42, page.get_data()[0]);
+      buffer_manager.unfix_page(page, false);
+    });
+    while (reads == 0) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(1, reads);
+  EXPECT_EQ(1, buffer_manager.get_stats().misses);
+  EXPECT_EQ(2, buffer_manager.get_stats().coalesced_misses);
+
+  // A failed read leaves the page unusable until a later fix reads it.
+  fail = true;
+  EXPECT_THROW(buffer_manager.fix_page(2, false), std::runtime_error);
+  uint64_t version;
+  EXPECT_EQ(nullptr, buffer_manager.fix_page_optimistic(2, version));
+  fail = false;
+  auto& page = buffer_manager.fix_page(2, false);
+  EXPECT_EQ(42, page.get_data()[0]);
+  buffer_manager.unfix_page(page, false);
+  EXPECT_EQ(3, reads);
+}
+
+TEST(BufferManagerTest, UpgradeAndDowngradeFixes) {
+  buzzdb::BufferManager buffer_manager{1024, 10};
+  auto& page = buffer_manager.fix_page(1, false);
+  auto& other = buffer_manager.fix_page(1, false);
+  EXPECT_FALSE(buffer_manager.try_upgrade_page(page));
+  buffer_manager.unfix_page(other, false);
+  ASSERT_TRUE(buffer_manager.try_upgrade_page(page));
+  uint64_t version;
+  EXPECT_EQ(nullptr, buffer_manager.fix_page_optimistic(1, version));
+  page.get_data()[0] = 7;
+  buffer_manager.downgrade_page(page);
+  EXPECT_EQ(7, buffer_manager.read_page(1, [](const char* data) { return data[0]; }));
+  buffer_manager.unfix_page(page, true);
+  EXPECT_TRUE(page.isDirty());
+
+  // Two fixes upgrading at once both get through; only one of them keeps
+  // its view of the page.
+  auto& counter = buffer_manager.fix_page(2, true);
+  counter.get_data()[0] = 0;
+  buffer_manager.unfix_page(counter, true);
+  std::atomic<size_t> fixed{0};
+  std::atomic<size_t> atomic_upgrades{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 2; ++i) {
+    threads.emplace_back([&] {
+      auto& page = buffer_manager.fix_page(2, false);
+      ++fixed;
+      while (fixed < 2) {
+        std::this_thread::yield();
+      }
+      if (buffer_manager.upgrade_page(page)) {
+        ++atomic_upgrades;
+      }
+      ++page.get_data()[0];
+      buffer_manager.unfix_page(page, true);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(1, atomic_upgrades);
+  EXPECT_EQ(2, buffer_manager.read_page(2, [](const char* data) { return data[0]; }));
+}
+
 TEST(BufferManagerTest, MultithreadReaderWriter) {
   {
     // Zero out all pages first
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include "buffer/frequency_sketch.h"
+
+namespace {
+
+TEST(FrequencySketchTest, EstimatesAccessCounts) {
+  buzzdb::FrequencySketch sketch{1024};
+  for (uint64_t page_id = 0; page_id < 512; ++page_id) {
+    for (uint64_t i = 0; i < page_id % 8; ++i) {
+      sketch.increment(page_id);
+    }
+  }
+  size_t exact = 0;
+  for (uint64_t page_id = 0; page_id < 512; ++page_id) {
+    // Collisions can only make an estimate too high.
+    EXPECT_GE(sketch.estimate(page_id), page_id % 8);
+    exact += sketch.estimate(page_id) == page_id % 8;
+  }
+  EXPECT_GT(exact, 480);
+  EXPECT_EQ(0, sketch.estimate(1 << 20));
+
+  // Counters saturate.
+  for (size_t i = 0; i < 100; ++i) {
+    sketch.increment(1000);
+  }
+  EXPECT_EQ(15, sketch.estimate(1000));
+}
+
+TEST(FrequencySketchTest, AgesCounters) {
+  buzzdb::FrequencySketch sketch{16};
+  // The sketch halves all counters after 10 * 16 increments.
+  for (size_t i = 0; i < 12; ++i) {
+    sketch.increment(7);
+  }
+  EXPECT_EQ(12, sketch.estimate(7));
+  for (uint64_t page_id = 100; page_id < 248; ++page_id) {
+    sketch.increment(page_id);
+  }
+  EXPECT_EQ(6, sketch.estimate(7));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <map>
+#include <random>
+
+#include "buffer/page_table.h"
+
+namespace {
+
+buzzdb::BufferFrame* fake_frame(uint64_t i) {
+  return reinterpret_cast<buzzdb::BufferFrame*>((i + 1) * 64);
+}
+
+TEST(PageTableTest, InsertFindErase) {
+  buzzdb::PageTable table{10};
+  for (uint64_t i = 0; i < 10; ++i) {
+    table.insert(i, fake_frame(i));
+  }
+  EXPECT_EQ(10, table.size());
+  for (uint64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(fake_frame(i), table.find(i));
+  }
+  EXPECT_EQ(nullptr, table.find(10));
+  EXPECT_TRUE(table.erase(3));
+  EXPECT_FALSE(table.erase(3));
+  EXPECT_EQ(nullptr, table.find(3));
+  EXPECT_EQ(9, table.size());
+}
+
+TEST(PageTableTest, RandomAgainstMap) {
+  // Churn a small table hard so that deletions have to shift clusters.
+  buzzdb::PageTable table{64};
+  std::map<uint64_t, buzzdb::BufferFrame*> expected;
+  std::mt19937_64 engine{0};
+  std::uniform_int_distribution<uint64_t> segment_distr{0, 3};
+  std::uniform_int_distribution<uint64_t> page_distr{0, 50};
+  for (size_t i = 0; i < 100000; ++i) {
+    uint64_t page_id = (segment_distr(engine) << 48) | page_distr(engine);
+    if (expected.count(page_id) != 0) {
+      EXPECT_TRUE(table.erase(page_id));
+      expected.erase(page_id);
+    } else if (expected.size() < 64) {
+      table.insert(page_id, fake_frame(i));
+      expected[page_id] = fake_frame(i);
+    }
+    ASSERT_EQ(expected.size(), table.size());
+  }
+  for (auto& [page_id, frame] : expected) {
+    EXPECT_EQ(frame, table.find(page_id));
+  }
+  size_t visited = 0;
+  table.for_each([&](uint64_t page_id, buzzdb::BufferFrame* frame) {
+    EXPECT_EQ(expected.at(page_id), frame);
+    ++visited;
+  });
+  EXPECT_EQ(expected.size(), visited);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
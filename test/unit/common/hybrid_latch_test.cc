@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "common/hybrid_latch.h"
+
+namespace {
+
+TEST(HybridLatchTest, ModesExcludeEachOther) {
+  buzzdb::HybridLatch latch;
+  EXPECT_EQ(8, sizeof(latch));
+  ASSERT_TRUE(latch.try_lock_shared());
+  ASSERT_TRUE(latch.try_lock_shared());
+  EXPECT_FALSE(latch.try_lock());
+  latch.unlock_shared();
+  EXPECT_FALSE(latch.try_lock());
+  latch.unlock_shared();
+  ASSERT_TRUE(latch.try_lock());
+  EXPECT_TRUE(latch.is_locked_exclusively());
+  EXPECT_FALSE(latch.try_lock());
+  EXPECT_FALSE(latch.try_lock_shared());
+  latch.unlock();
+  EXPECT_FALSE(latch.is_locked_exclusively());
+}
+
+TEST(HybridLatchTest, OptimisticReads) {
+  buzzdb::HybridLatch latch;
+  uint64_t version;
+  ASSERT_TRUE(latch.try_lock_optimistic(version));
+  // Shared holders do not invalidate optimistic readers.
+  latch.lock_shared();
+  latch.unlock_shared();
+  EXPECT_TRUE(latch.validate(version));
+
+  latch.lock();
+  EXPECT_FALSE(latch.validate(version));
+  uint64_t other_version;
+  EXPECT_FALSE(latch.try_lock_optimistic(other_version));
+  latch.unlock();
+  EXPECT_FALSE(latch.validate(version));
+  ASSERT_TRUE(latch.try_lock_optimistic(version));
+  EXPECT_TRUE(latch.validate(version));
+}
+
+TEST(HybridLatchTest, UpgradeAndDowngrade) {
+  buzzdb::HybridLatch latch;
+  latch.lock_shared();
+  latch.lock_shared();
+  EXPECT_FALSE(latch.try_upgrade());
+  latch.unlock_shared();
+  ASSERT_TRUE(latch.try_upgrade());
+  EXPECT_TRUE(latch.is_locked_exclusively());
+  EXPECT_FALSE(latch.try_lock_shared());
+  uint64_t version;
+  EXPECT_FALSE(latch.try_lock_optimistic(version));
+
+  latch.downgrade();
+  EXPECT_FALSE(latch.is_locked_exclusively());
+  ASSERT_TRUE(latch.try_lock_optimistic(version));
+  EXPECT_TRUE(latch.try_lock_shared());
+  EXPECT_FALSE(latch.try_lock());
+  latch.unlock_shared();
+  EXPECT_TRUE(latch.upgrade());
+  EXPECT_FALSE(latch.validate(version));
+  latch.unlock();
+}
+
+TEST(HybridLatchTest, ParkedWaitersAreWoken) {
+  // The holders sleep inside the latch, so the others spin out and park.
+  buzzdb::HybridLatch latch;
+  uint64_t counter = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([i, &latch, &counter] {
+      for (int j = 0; j < 20; ++j) {
+        if (i % 2 == 0) {
+          latch.lock();
+          uint64_t value = counter;
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+          counter = value + 1;
+          latch.unlock();
+        } else {
+          latch.lock_shared();
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+          EXPECT_LE(counter, 80);
+          latch.unlock_shared();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(80, counter);
+  EXPECT_TRUE(latch.try_lock());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
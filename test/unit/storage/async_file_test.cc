@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "storage/file.h"
+#include "storage/io_uring_file.h"
+
+namespace {
+
+constexpr const char* FILE_NAME = "async_file_test.dat";
+
+/// Opens a fresh test file, with io_uring if `use_io_uring` is set.
+std::unique_ptr<buzzdb::File> open_fresh(bool use_io_uring) {
+  ::unlink(FILE_NAME);
+  if (use_io_uring) {
+    return buzzdb::File::open_async_file(FILE_NAME, buzzdb::File::WRITE, 4);
+  }
+  return buzzdb::File::open_file(FILE_NAME, buzzdb::File::WRITE);
+}
+
+void check_write_then_read(bool use_io_uring) {
+  constexpr size_t BLOCK_SIZE = 4096;
+  constexpr size_t BLOCK_COUNT = 32;
+  auto file = open_fresh(use_io_uring);
+  file->resize(BLOCK_SIZE * BLOCK_COUNT);
+
+  // More requests than the queue depth, so submissions have to wait for
+  // completions.
+  std::vector<std::vector<char>> blocks;
+  for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+    blocks.emplace_back(BLOCK_SIZE, static_cast<char>(i));
+  }
+  size_t completed = 0;
+  for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+    file->write_block_async(blocks[i].data(), i * BLOCK_SIZE, BLOCK_SIZE,
+                            [&](int error) {
+                              EXPECT_EQ(0, error);
+                              ++completed;
+                            });
+  }
+  while (file->in_flight() != 0) {
+    file->poll(1);
+  }
+  EXPECT_EQ(BLOCK_COUNT, completed);
+
+  std::vector<char> read(BLOCK_SIZE * BLOCK_COUNT);
+  completed = 0;
+  for (size_t i = BLOCK_COUNT; i-- > 0;) {
+    file->read_block_async(i * BLOCK_SIZE, BLOCK_SIZE,
+                           read.data() + i * BLOCK_SIZE, [&](int error) {
+                             EXPECT_EQ(0, error);
+                             ++completed;
+                           });
+  }
+  while (file->in_flight() != 0) {
+    file->poll(1);
+  }
+  EXPECT_EQ(BLOCK_COUNT, completed);
+  for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+    EXPECT_EQ(0, std::memcmp(blocks[i].data(), read.data() + i * BLOCK_SIZE,
+                             BLOCK_SIZE));
+  }
+  file.reset();
+  ::unlink(FILE_NAME);
+}
+
+void check_read_past_end(bool use_io_uring) {
+  auto file = open_fresh(use_io_uring);
+  std::vector<char> block(1024, 'x');
+  bool done = false;
+  file->read_block_async(0, block.size(), block.data(), [&](int error) {
+    EXPECT_EQ(0, error);
+    done = true;
+  });
+  while (!done) {
+    file->poll(1);
+  }
+  EXPECT_EQ(std::vector<char>(1024, 0), block);
+  file.reset();
+  ::unlink(FILE_NAME);
+}
+
+TEST(AsyncFileTest, SynchronousFallback) {
+  check_write_then_read(false);
+  check_read_past_end(false);
+}
+
+TEST(AsyncFileTest, IoUring) {
+  if (!buzzdb::IoUringFile::is_supported()) {
+    // Nothing to test, open_async_file() falls back to the POSIX file.
+    return;
+  }
+  check_write_then_read(true);
+  check_read_past_end(true);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
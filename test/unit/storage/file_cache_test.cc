@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "storage/file_cache.h"
+#include "storage/test_file.h"
+
+namespace {
+
+TEST(FileCacheTest, OpensLazilyAndShares) {
+  std::vector<uint16_t> opened;
+  buzzdb::FileCache cache{4, [&](uint16_t segment_id) {
+                            opened.push_back(segment_id);
+                            return std::make_unique<buzzdb::TestFile>();
+                          }};
+  EXPECT_EQ(0, cache.size());
+  auto file = cache.get(1);
+  EXPECT_EQ(file, cache.get(1));
+  EXPECT_EQ(std::vector<uint16_t>{1}, opened);
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(FileCacheTest, ClosesLeastRecentlyUsed) {
+  std::vector<uint16_t> opened;
+  buzzdb::FileCache cache{2, [&](uint16_t segment_id) {
+                            opened.push_back(segment_id);
+                            return std::make_unique<buzzdb::TestFile>();
+                          }};
+  std::weak_ptr<buzzdb::File> first = cache.get(1);
+  cache.get(2);
+  cache.get(1);
+  // Segment 2 is the least recently used one now.
+  cache.get(3);
+  EXPECT_EQ(2, cache.size());
+  EXPECT_FALSE(first.expired());
+  cache.get(1);
+  EXPECT_EQ((std::vector<uint16_t>{1, 2, 3}), opened);
+  cache.get(2);
+  EXPECT_EQ((std::vector<uint16_t>{1, 2, 3, 2}), opened);
+}
+
+TEST(FileCacheTest, KeepsEvictedFileAliveWhileInUse) {
+  buzzdb::FileCache cache{1, [](uint16_t) {
+                            return std::make_unique<buzzdb::TestFile>();
+                          }};
+  auto in_use = cache.get(1);
+  std::weak_ptr<buzzdb::File> weak = in_use;
+  cache.get(2);
+  EXPECT_FALSE(weak.expired());
+  in_use.reset();
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(FileCacheTest, OpensWithoutBlockingOtherSegments) {
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<bool> opening = false;
+  buzzdb::FileCache cache{4, [&](uint16_t segment_id) {
+                            if (segment_id == 1) {
+                              opening = true;
+                              released.wait();
+                            }
+                            return std::make_unique<buzzdb::TestFile>();
+                          }};
+  std::thread slow_open{[&] { cache.get(1); }};
+  while (!opening) {
+    std::this_thread::yield();
+  }
+  // Segment 1 is still being opened.
+  cache.get(2);
+  EXPECT_EQ(1, cache.size());
+  release.set_value();
+  slow_open.join();
+  EXPECT_EQ(2, cache.size());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}